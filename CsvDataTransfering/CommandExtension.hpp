@@ -0,0 +1,117 @@
+#pragma once
+
+#include "tlm.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Commands understood by the ReceiverModel
+enum class CsvCommand : uint32_t
+{
+    LOAD_CSV,   // buffer = file path, loads the table
+    GET_HEADER, // result = header row as CSV text
+    GET_ROWS,   // args = {first row, row count}, result = rows as CSV text
+    GET_SIZE    // result args = {rows, columns}
+};
+
+// Reference-counted byte buffer: handed across the socket by sharing ownership, never copied
+typedef std::shared_ptr<std::vector<unsigned char>> SharedBuffer;
+
+inline SharedBuffer makeSharedBuffer(const std::string &text)
+{
+    return std::make_shared<std::vector<unsigned char>>(text.begin(), text.end());
+}
+
+inline std::string toString(const SharedBuffer &buffer)
+{
+    return buffer ? std::string(buffer->begin(), buffer->end()) : std::string();
+}
+
+class CommandExtension;
+
+// Free list of command extensions, so that issuing a command does not allocate
+class CommandExtensionPool
+{
+private:
+    std::vector<CommandExtension *> free_;
+
+public:
+    static CommandExtensionPool &instance()
+    {
+        static CommandExtensionPool pool;
+        return pool;
+    }
+
+    CommandExtension *allocate();
+    void release(CommandExtension *ext);
+    ~CommandExtensionPool();
+};
+
+// Typed command carried by a generic payload: opcode, arguments, and shared request/result buffers
+class CommandExtension : public tlm::tlm_extension<CommandExtension>
+{
+public:
+    CsvCommand opcode = CsvCommand::LOAD_CSV;
+    std::vector<uint64_t> args;    // Command arguments, replaced by result values on return
+    SharedBuffer buffer;           // Request payload (e.g. file path)
+    SharedBuffer result;           // Response payload (e.g. table block), owned jointly with the target
+
+    // Function to clear the command before it goes back to the pool
+    void clear()
+    {
+        opcode = CsvCommand::LOAD_CSV;
+        args.clear();
+        buffer.reset();
+        result.reset();
+    }
+
+    // Return to the pool instead of deleting
+    virtual void free()
+    {
+        CommandExtensionPool::instance().release(this);
+    }
+
+    virtual tlm::tlm_extension_base *clone() const
+    {
+        CommandExtension *ext = CommandExtensionPool::instance().allocate();
+        ext->copy_from(*this);
+        return ext;
+    }
+
+    // Buffers are shared, not copied
+    virtual void copy_from(tlm::tlm_extension_base const &ext)
+    {
+        const CommandExtension &other = static_cast<const CommandExtension &>(ext);
+        opcode = other.opcode;
+        args = other.args;
+        buffer = other.buffer;
+        result = other.result;
+    }
+};
+
+inline CommandExtension *CommandExtensionPool::allocate()
+{
+    if (free_.empty())
+    {
+        return new CommandExtension;
+    }
+    CommandExtension *ext = free_.back();
+    free_.pop_back();
+    return ext;
+}
+
+inline void CommandExtensionPool::release(CommandExtension *ext)
+{
+    ext->clear();
+    free_.push_back(ext);
+}
+
+inline CommandExtensionPool::~CommandExtensionPool()
+{
+    for (CommandExtension *ext : free_)
+    {
+        delete ext;
+    }
+}
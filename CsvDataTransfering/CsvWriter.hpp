@@ -0,0 +1,333 @@
+#pragma once
+
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <algorithm>
+
+// Counterpart of CsvReader: streams rows of typed fields into a CSV file.
+// Numbers are formatted with std::to_chars straight into a large output buffer,
+// and a full buffer is either written in place or handed to a background flusher
+// thread (double buffering) so the simulation never waits on the disk.
+class CsvWriter
+{
+private:
+    std::FILE *file_ = nullptr;   // Output file, unbuffered by stdio (we buffer ourselves)
+    std::vector<char> buffer_;    // Buffer currently being filled
+    std::vector<char> spare_;     // Buffer owned by the flusher thread while pending_ is set
+    size_t used_ = 0;             // Number of valid bytes in buffer_
+    size_t spareUsed_ = 0;        // Number of valid bytes in spare_
+    bool firstField_ = true;      // No separator needed before the next field
+    size_t rows_ = 0;             // Number of completed rows
+    std::string filename_;
+
+    // Background flushing state
+    bool background_ = false;
+    bool pending_ = false;
+    bool stop_ = false;
+    std::thread flusher_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    CsvWriter() = default;
+    CsvWriter(const CsvWriter &) = delete;
+    CsvWriter &operator=(const CsvWriter &) = delete;
+
+    ~CsvWriter()
+    {
+        close();
+    }
+
+    // Function to open a CSV file for writing, truncating any existing content
+    bool open(const std::string &filename, size_t bufferSize = DEFAULT_BUFFER_SIZE, bool backgroundFlush = false)
+    {
+        close();
+
+        file_ = std::fopen(filename.c_str(), "wb");
+        if (file_ == nullptr)
+        {
+            std::cerr << "Error: Could not open the file '" << filename << "'\n";
+            return false;
+        }
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+
+        filename_ = filename;
+        buffer_.assign(bufferSize < 64 ? 64 : bufferSize, '\0');
+        used_ = 0;
+        firstField_ = true;
+        rows_ = 0;
+
+        background_ = backgroundFlush;
+        if (background_)
+        {
+            spare_.assign(buffer_.size(), '\0');
+            pending_ = false;
+            stop_ = false;
+            flusher_ = std::thread(&CsvWriter::flusherLoop, this);
+        }
+        return true;
+    }
+
+    // Function to check whether a file is currently open
+    bool isOpen() const
+    {
+        return file_ != nullptr;
+    }
+
+    // Function to write the header row
+    void writeHeader(const std::vector<std::string> &header)
+    {
+        for (const auto &column : header)
+        {
+            writeField(std::string_view(column));
+        }
+        endRow();
+    }
+
+    // Function to append an integer field, optionally in another base (e.g. 16 for addresses)
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void writeField(T value, int base = 10)
+    {
+        separator(2 + 64);
+        if (base == 16)
+        {
+            buffer_[used_++] = '0';
+            buffer_[used_++] = 'x';
+        }
+        auto result = std::to_chars(&buffer_[used_], &buffer_[0] + buffer_.size(), value, base);
+        used_ = result.ptr - &buffer_[0];
+    }
+
+    // Function to append a floating point field in shortest round-trip form
+    void writeField(double value)
+    {
+        separator(32);
+        auto result = std::to_chars(&buffer_[used_], &buffer_[0] + buffer_.size(), value);
+        used_ = result.ptr - &buffer_[0];
+    }
+
+    // Function to append a single character field (e.g. 'R'/'W')
+    void writeField(char value)
+    {
+        writeField(std::string_view(&value, 1));
+    }
+
+    // Function to append a text field, quoted only when it contains separators or quotes
+    void writeField(std::string_view value)
+    {
+        bool quote = value.find_first_of(",\"\r\n") != std::string_view::npos;
+        if (!quote)
+        {
+            separator(0);
+            append(value.data(), value.size());
+            return;
+        }
+
+        separator(1);
+        buffer_[used_++] = '"';
+        size_t start = 0;
+        for (size_t pos = value.find('"'); pos != std::string_view::npos; pos = value.find('"', start))
+        {
+            append(value.data() + start, pos + 1 - start);
+            append("\"", 1);
+            start = pos + 1;
+        }
+        append(value.data() + start, value.size() - start);
+        append("\"", 1);
+    }
+
+    void writeField(const char *value)
+    {
+        writeField(std::string_view(value));
+    }
+
+    void writeField(const std::string &value)
+    {
+        writeField(std::string_view(value));
+    }
+
+    // Function to terminate the current row
+    void endRow()
+    {
+        reserve(1);
+        buffer_[used_++] = '\n';
+        firstField_ = true;
+        ++rows_;
+    }
+
+    // Function to write a complete row in one call, e.g. writeRow(time, 'W', addr, data)
+    template <typename... Fields>
+    void writeRow(const Fields &...fields)
+    {
+        (writeField(fields), ...);
+        endRow();
+    }
+
+    // Function to get the number of rows written so far (header included)
+    size_t getTotalRows() const
+    {
+        return rows_;
+    }
+
+    // Function to push buffered rows to the file. With background flushing the data
+    // is handed to the flusher thread and this call waits until it is on disk.
+    void flush()
+    {
+        if (file_ == nullptr)
+        {
+            return;
+        }
+
+        if (background_)
+        {
+            handOff();
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]
+                     { return !pending_; });
+        }
+        else
+        {
+            writeOut(buffer_.data(), used_);
+            used_ = 0;
+        }
+        std::fflush(file_);
+    }
+
+    // Function to flush the remaining rows and close the file
+    void close()
+    {
+        if (file_ == nullptr)
+        {
+            return;
+        }
+
+        flush();
+        if (background_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            flusher_.join();
+            background_ = false;
+        }
+
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    // Make room for the field separator plus 'extra' bytes of payload
+    void separator(size_t extra)
+    {
+        reserve(extra + 1);
+        if (!firstField_)
+        {
+            buffer_[used_++] = ',';
+        }
+        firstField_ = false;
+    }
+
+    // Append raw bytes, spilling the buffer as many times as needed
+    void append(const char *data, size_t len)
+    {
+        while (len > 0)
+        {
+            if (used_ == buffer_.size())
+            {
+                spill();
+            }
+            size_t chunk = std::min(len, buffer_.size() - used_);
+            std::copy(data, data + chunk, &buffer_[used_]);
+            used_ += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+
+    void reserve(size_t len)
+    {
+        if (used_ + len > buffer_.size())
+        {
+            spill();
+        }
+    }
+
+    // Get rid of the filled buffer without waiting for the disk if possible
+    void spill()
+    {
+        if (background_)
+        {
+            handOff();
+        }
+        else
+        {
+            writeOut(buffer_.data(), used_);
+            used_ = 0;
+        }
+    }
+
+    // Swap the filled buffer with the spare one and wake up the flusher thread.
+    // Only blocks when the flusher is still busy with the previous buffer.
+    void handOff()
+    {
+        if (used_ == 0)
+        {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]
+                     { return !pending_; });
+            buffer_.swap(spare_);
+            spareUsed_ = used_;
+            used_ = 0;
+            pending_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    void flusherLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            cv_.wait(lock, [this]
+                     { return pending_ || stop_; });
+            if (pending_)
+            {
+                // spare_ is owned by this thread until pending_ is cleared
+                lock.unlock();
+                writeOut(spare_.data(), spareUsed_);
+                lock.lock();
+                pending_ = false;
+                cv_.notify_all();
+            }
+            else if (stop_)
+            {
+                return;
+            }
+        }
+    }
+
+    void writeOut(const char *data, size_t len)
+    {
+        if (len != 0 && std::fwrite(data, 1, len, file_) != len)
+        {
+            std::cerr << "Error: Could not write to the file '" << filename_ << "'\n";
+        }
+    }
+};
@@ -2,6 +2,7 @@
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
+#include "CommandExtension.hpp"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -34,28 +35,60 @@ public:
         wait(delay);
     }
 
-    void sendCsvPath(string csv_file_path)
+    /**
+     * @brief Issue a typed command to the receiver
+     * The command travels in a pooled CommandExtension; request and result buffers are shared,
+     * so large blocks cross the socket without being copied.
+     * @return the response status, result values are left in args and result
+     */
+    tlm::tlm_response_status sendCommand(CsvCommand opcode, vector<uint64_t> &args,
+                                         const SharedBuffer &buffer, SharedBuffer &result)
     {
-        tlm::tlm_generic_payload *trans = new tlm::tlm_generic_payload;
+        tlm::tlm_generic_payload trans;
         sc_time delay = sc_time(10, SC_NS);
-        int addr_cmd = 0xAABB;
 
-        // Initialize 8 out of the 10 attributes, byte_enable_length and extensions being unused
-        trans->set_command(tlm::TLM_WRITE_COMMAND);                             // Set the command for the transaction. The cmd variable likely holds a value from the tlm::tlm_command enumeration, indicating the type of transaction (e.g., read or write).
-        trans->set_address(addr_cmd);                                           // Set the address for the transaction. This line is configuring the address where the transaction will read from or write to.
-        trans->set_data_ptr(reinterpret_cast<unsigned char *>(&csv_file_path)); // Set the data pointer for the transaction, converting to unsigned char*. This pointer references the data to be transferred.
-        trans->set_data_length(csv_file_path.length());                         // Set the length of the data associated with the transaction to 4 bytes.                                        // Set the streaming width for burst transfers (4 bytes, indicating no streaming).
-        trans->set_byte_enable_ptr(0);                                          // Set the byte-enable pointer for the transaction. 0 indicates that byte enables are not used.
-        trans->set_dmi_allowed(false);                                          // Set whether DMI (Direct Memory Interface) is allowed for this transaction. DMI allows direct access to memory without regular transaction processing.
-        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);               // Set the response status of the transaction to indicate an incomplete response. Actual response status may be updated based on the outcome of the transaction.
+        CommandExtension *ext = CommandExtensionPool::instance().allocate();
+        ext->opcode = opcode;
+        ext->args = args;
+        ext->buffer = buffer;
+
+        // The data of the command lives in the extension, the payload itself carries no data
+        trans.set_command(tlm::TLM_IGNORE_COMMAND);
+        trans.set_address(0);
+        trans.set_data_ptr(0);
+        trans.set_data_length(0);
+        trans.set_streaming_width(0);
+        trans.set_byte_enable_ptr(0);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans.set_extension(ext);
+
+        socket->b_transport(trans, delay); // Blocking transport call
 
-        socket->b_transport(*trans, delay); // Blocking transport call
+        args = ext->args;
+        result = ext->result;
+
+        // Give the extension back to the pool, the result buffer stays alive through 'result'
+        trans.clear_extension(ext);
+        ext->free();
+
+        return trans.get_response_status();
+    }
 
-        // Initiator obliged to check response status and delay
-        if (trans->is_response_error())
+    void sendCsvPath(string csv_file_path)
+    {
+        vector<uint64_t> args;
+        SharedBuffer result;
+
+        tlm::tlm_response_status status = sendCommand(CsvCommand::LOAD_CSV, args, makeSharedBuffer(csv_file_path), result);
+
+        // Initiator obliged to check response status
+        if (status != tlm::TLM_OK_RESPONSE)
         {
             SC_REPORT_ERROR("TLM-2", "Response error from b_transport");
         }
+
+        database_file_ = csv_file_path;
     }
 
 private:
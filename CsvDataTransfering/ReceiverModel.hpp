@@ -3,6 +3,9 @@
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 #include "CsvReader.hpp"
+#include "CommandExtension.hpp"
+
+#include <algorithm>
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -32,49 +35,123 @@ public:
     // TLM-2 blocking transport method
     virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
     {
-        tlm::tlm_command cmd = trans.get_command();       // Get transaction commands such as TLM_READ_COMMAND or TLM_WRITE_COMMAND.
-        sc_dt::uint64 adr = trans.get_address() / 4;      // Get get transaction address. The division by 4 suggests that the address might be byte-addressed, and this operation converts it to a word-addressed format.
-        unsigned char *ptr = trans.get_data_ptr();        // This pointer can be used to access or manipulate the data being transferred in the transaction
-        unsigned int len = trans.get_data_length();       // This variable indicates the number of bytes in the data buffer.
-        unsigned char *byt = trans.get_byte_enable_ptr(); // Byte enables are used to specify which bytes in a data buffer are valid or should be modified during the transaction.
-        unsigned int wid = trans.get_streaming_width();   // Streaming width is used in burst transfers to specify the number of bytes that can be transferred in a single burst
-
-        // Obliged to implement read and write commands
-        if (cmd == tlm::TLM_WRITE_COMMAND)
+        // Commands travel in a CommandExtension, anything else is not understood by this target
+        CommandExtension *ext = nullptr;
+        trans.get_extension(ext);
+        if (!ext)
+        {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            std::cout << "Error: TLM_COMMAND_ERROR_RESPONSE, no command extension" << std::endl;
+            return;
+        }
+
+        switch (ext->opcode)
         {
-            // Assuming the buffer contains a null-terminated string, convert it to std::string
-            std::string csv_path(reinterpret_cast<const char *>(ptr));
-            if (table_data.readCsv(csv_path))
+        case CsvCommand::LOAD_CSV:
+            if (!loadCsv(toString(ext->buffer)))
             {
-                // Example usage:
-                std::cout << "Table Header:\n";
-                const auto &header = table_data.getTableHeader();
-                for (const auto &column : header)
-                {
-                    std::cout << column << " ";
-                }
-                std::cout << "\n";
+                trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+                return;
+            }
+            break;
 
-                // Get header with column indices
-                auto headerWithIndices = table_data.getHeaderWithIndices();
-                std::cout << "Header with Indices:\n";
-                for (const auto &pair : headerWithIndices)
-                {
-                    std::cout << pair.first << " at index " << pair.second << "\n";
-                }
+        case CsvCommand::GET_HEADER:
+        {
+            const auto &header = table_data.getTableHeader();
+            ext->result = rowsToCsv(&header, 0, 0);
+            break;
+        }
 
-                std::cout << "Total Rows: " << table_data.getTotalRows() << "\n";
-                std::cout << "Total Columns: " << table_data.getTotalColumns() << "\n";
+        case CsvCommand::GET_ROWS:
+        {
+            if (ext->args.size() < 2 || ext->args[0] > table_data.getTotalRows())
+            {
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                std::cout << "Error: TLM_ADDRESS_ERROR_RESPONSE, bad row range" << std::endl;
+                return;
+            }
+            ext->result = rowsToCsv(nullptr, ext->args[0], ext->args[1]);
+            break;
+        }
+
+        case CsvCommand::GET_SIZE:
+            ext->args = {table_data.getTotalRows(), table_data.getTotalColumns()};
+            break;
+
+        default:
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            std::cout << "Error: TLM_COMMAND_ERROR_RESPONSE, unknown command "
+                      << static_cast<uint32_t>(ext->opcode) << std::endl;
+            return;
+        }
 
-                // Print cell values in the first row
+        // Obliged to set response status to indicate successful completion
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+private:
+    bool loadCsv(const std::string &csv_path)
+    {
+        table_data.clearData();
+        if (!table_data.readCsv(csv_path))
+        {
+            return false;
+        }
+
+        // Example usage:
+        std::cout << "Table Header:\n";
+        const auto &header = table_data.getTableHeader();
+        for (const auto &column : header)
+        {
+            std::cout << column << " ";
+        }
+        std::cout << "\n";
+
+        // Get header with column indices
+        auto headerWithIndices = table_data.getHeaderWithIndices();
+        std::cout << "Header with Indices:\n";
+        for (const auto &pair : headerWithIndices)
+        {
+            std::cout << pair.first << " at index " << pair.second << "\n";
+        }
+
+        std::cout << "Total Rows: " << table_data.getTotalRows() << "\n";
+        std::cout << "Total Columns: " << table_data.getTotalColumns() << "\n";
+
+        // Print cell values in the first row
+        for (size_t col = 0; col < table_data.getTotalColumns(); ++col)
+        {
+            std::cout << "Cell(" << 0 << "," << col << "): " << table_data.getCellValue(0, col) << "\n";
+        }
+        return true;
+    }
+
+    // Serialize the header (if given) or a block of rows as CSV text into a new shared buffer
+    SharedBuffer rowsToCsv(const std::vector<std::string> *header, uint64_t first, uint64_t count)
+    {
+        std::string text;
+        if (header)
+        {
+            for (size_t col = 0; col < header->size(); ++col)
+            {
+                text += (col ? "," : "") + (*header)[col];
+            }
+            text += "\n";
+        }
+        else
+        {
+            // first <= rows is checked by the caller; compare without adding, first + count may wrap
+            uint64_t rows = table_data.getTotalRows();
+            uint64_t last = count > rows - first ? rows : first + count;
+            for (uint64_t row = first; row < last; ++row)
+            {
                 for (size_t col = 0; col < table_data.getTotalColumns(); ++col)
                 {
-                    std::cout << "Cell(" << 0 << "," << col << "): " << table_data.getCellValue(0, col) << "\n";
+                    text += (col ? "," : "") + table_data.getCellValue(row, col);
                 }
-
-                // Obliged to set response status to indicate successful completion
-                trans.set_response_status(tlm::TLM_OK_RESPONSE);
+                text += "\n";
             }
         }
+        return makeSharedBuffer(text);
     }
 };
@@ -16,5 +16,19 @@ int main(void)
     initiator->socket.bind(receiver->socket);
     initiator->sendCsvPath("example.csv");
 
+    // Fetch a block of rows, the result buffer is shared with the receiver rather than copied
+    vector<uint64_t> args = {0, 2};
+    SharedBuffer rows;
+    if (initiator->sendCommand(CsvCommand::GET_ROWS, args, nullptr, rows) == tlm::TLM_OK_RESPONSE)
+    {
+        std::cout << "Rows 0-1:\n"
+                  << toString(rows);
+    }
+
+    // Unknown commands are rejected with a command error response
+    args.clear();
+    tlm::tlm_response_status status = initiator->sendCommand(static_cast<CsvCommand>(0xAABB), args, nullptr, rows);
+    std::cout << "Unknown command response: " << (status == tlm::TLM_COMMAND_ERROR_RESPONSE ? "TLM_COMMAND_ERROR_RESPONSE" : "unexpected") << "\n";
+
     sc_start();
 }
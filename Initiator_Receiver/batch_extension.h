@@ -0,0 +1,121 @@
+#pragma once
+
+#include "systemc"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include <vector>
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+/// Batched transport: one generic payload carries many independent sub-transactions.
+///
+/// The carrier payload is a TLM_IGNORE_COMMAND of length 0, so the extension is
+/// ignorable: a target that does not know it completes the carrier without side
+/// effects and leaves every entry at TLM_INCOMPLETE_RESPONSE, which the initiator
+/// detects. Batch-aware targets (Memory) process the whole vector in one call;
+/// other targets are put behind an Unbatcher.
+
+struct BatchEntry
+{
+    tlm::tlm_command command;
+    sc_dt::uint64 address;
+    unsigned int length;
+    unsigned char *data;
+    tlm::tlm_response_status response;
+    sc_time latency; // Delay the target annotated for this entry, also included in the carrier's delay
+};
+
+class BatchExtension : public tlm::tlm_extension<BatchExtension>
+{
+public:
+    vector<BatchEntry> entries;
+
+    void add(tlm::tlm_command command, sc_dt::uint64 address, unsigned char *data, unsigned int length)
+    {
+        entries.push_back({command, address, length, data, tlm::TLM_INCOMPLETE_RESPONSE, SC_ZERO_TIME});
+    }
+
+    // Set up the carrier payload for this batch
+    void prepare(tlm::tlm_generic_payload &trans)
+    {
+        trans.set_command(tlm::TLM_IGNORE_COMMAND);
+        trans.set_address(entries.empty() ? 0 : entries[0].address);
+        trans.set_data_ptr(0);
+        trans.set_data_length(0);
+        trans.set_streaming_width(0);
+        trans.set_byte_enable_ptr(0);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans.set_extension(this);
+    }
+
+    virtual tlm::tlm_extension_base *clone() const
+    {
+        BatchExtension *ext = new BatchExtension;
+        ext->entries = entries;
+        return ext;
+    }
+
+    virtual void copy_from(tlm::tlm_extension_base const &ext)
+    {
+        entries = static_cast<BatchExtension const &>(ext).entries;
+    }
+};
+
+/// Adapter placed in front of a target that is not batch-aware: every entry of a
+/// batch is issued downstream as an ordinary transaction and its response is
+/// copied back into the entry. Transactions without a batch pass through.
+
+class Unbatcher : sc_module
+{
+public:
+    // Upstream side, bound by the initiator
+    tlm_utils::simple_target_socket<Unbatcher> target_socket;
+
+    // Downstream side, bound to the target
+    tlm_utils::simple_initiator_socket<Unbatcher> initiator_socket;
+
+    Unbatcher(sc_core::sc_module_name name) : target_socket("target_socket"), initiator_socket("initiator_socket")
+    {
+        // Register callback for incoming b_transport interface method call
+        target_socket.register_b_transport(this, &Unbatcher::b_transport);
+    }
+
+private:
+    tlm::tlm_generic_payload single; // Reused for every entry
+
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        BatchExtension *batch = nullptr;
+        trans.get_extension(batch);
+        if (!batch)
+        {
+            initiator_socket->b_transport(trans, delay);
+            return;
+        }
+
+        for (BatchEntry &entry : batch->entries)
+        {
+            single.set_command(entry.command);
+            single.set_address(entry.address);
+            single.set_data_ptr(entry.data);
+            single.set_data_length(entry.length);
+            single.set_streaming_width(entry.length);                 // = data_length to indicate no streaming
+            single.set_byte_enable_ptr(0);                            // 0 indicates unused
+            single.set_dmi_allowed(false);                            // Mandatory initial value
+            single.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE); // Mandatory initial value
+
+            sc_time before = delay;
+            initiator_socket->b_transport(single, delay);
+            entry.response = single.get_response_status();
+            entry.latency = delay - before;
+        }
+
+        // The carrier itself always completes, errors are reported per entry
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "systemc"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include <vector>
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+/// Set-associative cache placed between an initiator socket and a target.
+///
+/// Hits are served locally; only misses (line fills) and evictions (write-backs)
+/// go downstream, as burst transactions of one cache line. Write-back caches
+/// allocate on write misses, write-through caches forward every write and do
+/// not allocate. Transactions that cross a line boundary, use byte enables or
+/// streaming are passed through uncached. The downstream target must accept
+/// bursts of one line.
+
+class Cache : sc_module
+{
+public:
+    // Upstream side, bound by the initiator
+    tlm_utils::simple_target_socket<Cache> target_socket;
+
+    // Downstream side, bound to the memory
+    tlm_utils::simple_initiator_socket<Cache> initiator_socket;
+
+    // Latency annotated on a hit, misses additionally carry the downstream latency
+    sc_time hit_latency = sc_time(1, SC_NS);
+
+    // Statistics
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;      // Valid lines replaced
+    unsigned long long write_backs = 0;    // Dirty lines written downstream
+    unsigned long long downstream_transactions = 0;
+    unsigned long long downstream_bytes = 0;
+
+    SC_HAS_PROCESS(Cache);
+    Cache(sc_core::sc_module_name name,
+          unsigned int size_bytes = 256, // Total capacity
+          unsigned int line_bytes = 16,  // Line size, a power of two
+          unsigned int ways = 2,         // Associativity
+          bool write_back = true)        // Write-back + write-allocate, or write-through + no-allocate
+        : target_socket("target_socket"), initiator_socket("initiator_socket"),
+          line_bytes(line_bytes), ways(ways),
+          sets(line_bytes != 0 && ways != 0 ? size_bytes / (line_bytes * ways) : 0), write_back(write_back)
+    {
+        // Register callback for incoming b_transport interface method call
+        target_socket.register_b_transport(this, &Cache::b_transport);
+
+        // Without lines every access passes straight through
+        if (line_bytes == 0 || (line_bytes & (line_bytes - 1)) != 0 || ways == 0 || sets == 0)
+        {
+            SC_REPORT_ERROR("Cache", "Cache size must hold at least one set and line size must be a power of two");
+            return;
+        }
+
+        lines.resize(sets * ways);
+        for (Line &line : lines)
+            line.data.resize(line_bytes);
+    }
+
+    /**
+     * @brief Write all dirty lines back downstream
+     * Must be called from a thread process if the downstream target may wait.
+     */
+    void flush(sc_time &delay)
+    {
+        for (Line &line : lines)
+        {
+            if (line.valid && line.dirty)
+            {
+                if (!write_line(line, delay))
+                    return;
+                line.dirty = false;
+            }
+        }
+    }
+
+    void print_statistics() const
+    {
+        cout << name() << ": " << dec << hits << " hits, " << misses << " misses, "
+             << evictions << " evictions, " << write_backs << " write-backs, "
+             << downstream_transactions << " downstream transactions (" << downstream_bytes << " bytes)" << endl;
+    }
+
+private:
+    struct Line
+    {
+        bool valid = false;
+        bool dirty = false;
+        sc_dt::uint64 tag = 0;
+        unsigned long long last_use = 0; // For LRU replacement
+        vector<unsigned char> data;
+    };
+
+    const unsigned int line_bytes;
+    const unsigned int ways;
+    const unsigned int sets;
+    const bool write_back;
+
+    vector<Line> lines;             // sets * ways lines, the ways of a set are contiguous
+    unsigned long long use_counter = 0;
+    tlm::tlm_generic_payload downstream; // Reused for every line fill and write-back
+
+    // TLM-2 blocking transport method
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        tlm::tlm_command cmd = trans.get_command();
+        sc_dt::uint64 adr = trans.get_address();
+        unsigned char *ptr = trans.get_data_ptr();
+        unsigned int len = trans.get_data_length();
+        unsigned int offset = lines.empty() ? 0 : adr % line_bytes;
+
+        // Anything the cache cannot handle as a single-line access goes straight through
+        if (lines.empty() || trans.get_byte_enable_ptr() != 0 || trans.get_streaming_width() < len ||
+            offset + len > line_bytes || (cmd != tlm::TLM_READ_COMMAND && cmd != tlm::TLM_WRITE_COMMAND))
+        {
+            initiator_socket->b_transport(trans, delay);
+            return;
+        }
+
+        sc_dt::uint64 line_adr = adr / line_bytes;
+        unsigned int set = line_adr % sets;
+        sc_dt::uint64 tag = line_adr / sets;
+
+        Line *line = lookup(set, tag);
+        if (line)
+        {
+            hits++;
+            delay += hit_latency;
+        }
+        else
+        {
+            misses++;
+
+            // Write-through caches do not allocate on a write miss
+            if (cmd == tlm::TLM_WRITE_COMMAND && !write_back)
+            {
+                initiator_socket->b_transport(trans, delay);
+                count_downstream(len);
+                return;
+            }
+
+            line = &victim(set);
+            if (line->valid)
+            {
+                evictions++;
+                if (line->dirty && !write_line(*line, delay))
+                {
+                    trans.set_response_status(downstream.get_response_status());
+                    return;
+                }
+            }
+
+            line->valid = false;
+            line->dirty = false;
+            line->tag = tag;
+            if (!transfer_line(tlm::TLM_READ_COMMAND, line_adr * line_bytes, *line, delay))
+            {
+                trans.set_response_status(downstream.get_response_status());
+                return;
+            }
+            line->valid = true;
+        }
+        line->last_use = ++use_counter;
+
+        if (cmd == tlm::TLM_READ_COMMAND)
+        {
+            memcpy(ptr, &line->data[offset], len);
+        }
+        else
+        {
+            memcpy(&line->data[offset], ptr, len);
+            if (write_back)
+            {
+                line->dirty = true;
+            }
+            else
+            {
+                initiator_socket->b_transport(trans, delay);
+                count_downstream(len);
+                return;
+            }
+        }
+
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    Line *lookup(unsigned int set, sc_dt::uint64 tag)
+    {
+        for (unsigned int way = 0; way < ways; way++)
+        {
+            Line &line = lines[set * ways + way];
+            if (line.valid && line.tag == tag)
+                return &line;
+        }
+        return nullptr;
+    }
+
+    // Invalid way if there is one, else the least recently used
+    Line &victim(unsigned int set)
+    {
+        Line *lru = &lines[set * ways];
+        for (unsigned int way = 0; way < ways; way++)
+        {
+            Line &line = lines[set * ways + way];
+            if (!line.valid)
+                return line;
+            if (line.last_use < lru->last_use)
+                lru = &line;
+        }
+        return *lru;
+    }
+
+    bool write_line(Line &line, sc_time &delay)
+    {
+        write_backs++;
+        return transfer_line(tlm::TLM_WRITE_COMMAND, (line.tag * sets + (&line - &lines[0]) / ways) * line_bytes, line, delay);
+    }
+
+    // Move one whole line to or from the downstream target as a single burst
+    bool transfer_line(tlm::tlm_command cmd, sc_dt::uint64 adr, Line &line, sc_time &delay)
+    {
+        downstream.set_command(cmd);
+        downstream.set_address(adr);
+        downstream.set_data_ptr(line.data.data());
+        downstream.set_data_length(line_bytes);
+        downstream.set_streaming_width(line_bytes);                   // = data_length to indicate no streaming
+        downstream.set_byte_enable_ptr(0);                            // 0 indicates unused
+        downstream.set_dmi_allowed(false);                            // Mandatory initial value
+        downstream.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE); // Mandatory initial value
+
+        initiator_socket->b_transport(downstream, delay);
+        count_downstream(line_bytes);
+
+        return !downstream.is_response_error();
+    }
+
+    void count_downstream(unsigned int bytes)
+    {
+        downstream_transactions++;
+        downstream_bytes += bytes;
+    }
+};
@@ -2,6 +2,8 @@
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
+#include "CsvWriter.hpp"
+#include "batch_extension.h"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -18,6 +20,19 @@ public:
     // TLM-2 socket, defaults to 32-bits wide, base protocol
     tlm_utils::simple_initiator_socket<Initiator> socket;
 
+    // Optional per-transaction trace, one CSV row per b_transport (nullptr = disabled)
+    CsvWriter *trace = nullptr;
+
+    // Run-time parameters, set before sc_start
+    unsigned int transactions = 16;  // Number of transactions to issue
+    unsigned int size = 4;           // Bytes per transaction
+    sc_time quantum = SC_ZERO_TIME;  // Temporal decoupling quantum, zero = wait after each transaction
+    bool verbose = true;             // Print every transaction
+    unsigned int batch = 1;          // Transactions carried per b_transport call (BatchExtension if > 1)
+
+    // Number of transactions completed so far
+    unsigned long long completed = 0;
+
     // This is the class constructor.
     SC_HAS_PROCESS(Initiator);
     Initiator(sc_core::sc_module_name name) : socket("socket") // Construct and name socket
@@ -32,13 +47,27 @@ private:
 
     void thread_process()
     {
+        if (batch > 1)
+        {
+            batched_process();
+            return;
+        }
+
         // TLM-2 generic payload transaction, reused across calls to b_transport
         tlm::tlm_generic_payload *trans = new tlm::tlm_generic_payload;
         sc_time delay = sc_time(10, SC_NS);
 
+        // Time this initiator has run ahead of the kernel when a quantum is used
+        sc_time local_time = SC_ZERO_TIME;
+
         // Generate a random sequence of reads and writes
-        for (int i = 32; i < 96; i += 4)
+        for (unsigned int n = 0; n < transactions; n++)
         {
+            // Addresses 32..92 as in the original sequence, wrapped around for longer runs
+            int i = 32 + (n * 4) % 64;
+
+            // Start every transaction with the initiator's own delay, the target may add to it
+            delay = sc_time(10, SC_NS);
 
             tlm::tlm_command cmd = static_cast<tlm::tlm_command>(rand() % 2);
             if (cmd == tlm::TLM_WRITE_COMMAND)
@@ -48,8 +77,8 @@ private:
             trans->set_command(cmd);                                       // Set the command for the transaction. The cmd variable likely holds a value from the tlm::tlm_command enumeration, indicating the type of transaction (e.g., read or write).
             trans->set_address(i);                                         // Set the address for the transaction. This line is configuring the address where the transaction will read from or write to.
             trans->set_data_ptr(reinterpret_cast<unsigned char *>(&data)); // Set the data pointer for the transaction, converting to unsigned char*. This pointer references the data to be transferred.
-            trans->set_data_length(4);                                     // Set the length of the data associated with the transaction to 4 bytes.
-            trans->set_streaming_width(4);                                 // Set the streaming width for burst transfers (4 bytes, indicating no streaming).
+            trans->set_data_length(size);                                  // Set the length of the data associated with the transaction (4 bytes by default).
+            trans->set_streaming_width(size);                              // Set the streaming width for burst transfers (= data length, indicating no streaming).
             trans->set_byte_enable_ptr(0);                                 // Set the byte-enable pointer for the transaction. 0 indicates that byte enables are not used.
             trans->set_dmi_allowed(false);                                 // Set whether DMI (Direct Memory Interface) is allowed for this transaction. DMI allows direct access to memory without regular transaction processing.
             trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);      // Set the response status of the transaction to indicate an incomplete response. Actual response status may be updated based on the outcome of the transaction.
@@ -62,12 +91,110 @@ private:
                 SC_REPORT_ERROR("TLM-2", "Response error from b_transport");
             }
 
-            cout << "trans = { " << (cmd ? 'W' : 'R') << ", " << hex << i
-                 << " } , data = " << hex << data << " at time " << sc_time_stamp()
-                 << " delay = " << delay << endl;
+            completed++;
+
+            if (verbose)
+                cout << "trans = { " << (cmd ? 'W' : 'R') << ", " << hex << i
+                     << " } , data = " << hex << data << " at time " << sc_time_stamp() + local_time
+                     << " delay = " << delay << endl;
+
+            if (trace)
+                trace->writeRow((sc_time_stamp() + local_time).value(), (cmd ? 'W' : 'R'), i, static_cast<unsigned int>(data), delay.value());
+
+            // Realize the delay annotated onto the transport call, either immediately or
+            // once the accumulated local time reaches the quantum (temporal decoupling)
+            if (quantum == SC_ZERO_TIME)
+            {
+                wait(delay);
+            }
+            else
+            {
+                local_time += delay;
+                if (local_time >= quantum)
+                {
+                    wait(local_time);
+                    local_time = SC_ZERO_TIME;
+                }
+            }
+        }
+
+        if (local_time > SC_ZERO_TIME)
+            wait(local_time);
+    }
+
+    // Same transaction sequence as thread_process, but 'batch' transactions share one
+    // b_transport call through a BatchExtension and the time is realized once per batch
+    void batched_process()
+    {
+        tlm::tlm_generic_payload *trans = new tlm::tlm_generic_payload;
+        BatchExtension *ext = new BatchExtension;
+        vector<int> buffer(batch); // One data word per entry
+
+        sc_time local_time = SC_ZERO_TIME;
+
+        for (unsigned int n = 0; n < transactions;)
+        {
+            ext->entries.clear();
+            for (unsigned int k = 0; k < batch && n < transactions; k++, n++)
+            {
+                int i = 32 + (n * 4) % 64;
+                tlm::tlm_command cmd = static_cast<tlm::tlm_command>(rand() % 2);
+                if (cmd == tlm::TLM_WRITE_COMMAND)
+                    buffer[k] = 0xFF000000 | i;
+                ext->add(cmd, i, reinterpret_cast<unsigned char *>(&buffer[k]), size);
+            }
+
+            // The initiator's own 10 ns is charged per entry, as for unbatched transactions,
+            // so that batching saves host time without changing simulated time
+            sc_time delay = sc_time(10, SC_NS) * double(ext->entries.size());
+            ext->prepare(*trans);
+
+            socket->b_transport(*trans, delay); // One blocking transport call for the whole batch
+
+            // Initiator obliged to check response status, of the carrier and of every entry
+            if (trans->is_response_error())
+            {
+                SC_REPORT_ERROR("TLM-2", "Response error from b_transport");
+            }
+
+            // Entry k is reported at the time it would have been issued unbatched,
+            // i.e. after the initiator delay and target latency of the entries before it
+            sc_time offset = SC_ZERO_TIME;
+            for (size_t k = 0; k < ext->entries.size(); k++)
+            {
+                const BatchEntry &entry = ext->entries[k];
+                sc_time entry_delay = sc_time(10, SC_NS) + entry.latency;
+                if (entry.response != tlm::TLM_OK_RESPONSE)
+                {
+                    SC_REPORT_ERROR("TLM-2", "Batch entry not completed, is the target batch-aware or behind an Unbatcher?");
+                }
+
+                completed++;
 
-            // Realize the delay annotated onto the transport call
-            wait(delay);
+                if (verbose)
+                    cout << "trans = { " << (entry.command ? 'W' : 'R') << ", " << hex << entry.address
+                         << " } , data = " << hex << buffer[k] << " at time " << sc_time_stamp() + local_time + offset
+                         << " delay = " << entry_delay << endl;
+
+                if (trace)
+                    trace->writeRow((sc_time_stamp() + local_time + offset).value(), (entry.command ? 'W' : 'R'), entry.address, static_cast<unsigned int>(buffer[k]), entry_delay.value());
+
+                offset += entry_delay;
+            }
+
+            // Realize the delay of the whole batch
+            local_time += delay;
+            if (local_time >= quantum)
+            {
+                wait(local_time);
+                local_time = SC_ZERO_TIME;
+            }
         }
+
+        if (local_time > SC_ZERO_TIME)
+            wait(local_time);
+
+        trans->clear_extension(ext);
+        delete ext;
     }
 };
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "systemc"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+#include "CsvWriter.hpp"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+/// Initiator generating the same generic payload transactions as Initiator, but driven
+/// by an SC_METHOD with next_trigger instead of an SC_THREAD with wait.
+///
+/// A method process has no stack of its own, so every activation is a plain function
+/// call from the kernel rather than a coroutine context switch. The loop of
+/// Initiator::thread_process is unrolled into an explicit state machine whose state
+/// survives between activations in member variables.
+///
+/// Because a method process cannot wait, the target must not call wait() inside
+/// b_transport (true for the Memory of this example).
+
+class MethodInitiator : sc_module
+{
+public:
+    // TLM-2 socket, defaults to 32-bits wide, base protocol
+    tlm_utils::simple_initiator_socket<MethodInitiator> socket;
+
+    // Optional per-transaction trace, one CSV row per b_transport (nullptr = disabled)
+    CsvWriter *trace = nullptr;
+
+    // Run-time parameters, set before sc_start
+    unsigned int transactions = 16;  // Number of transactions to issue
+    unsigned int size = 4;           // Bytes per transaction
+    sc_time quantum = SC_ZERO_TIME;  // Temporal decoupling quantum, zero = yield after each transaction
+    bool verbose = true;             // Print every transaction
+
+    // Number of transactions completed so far
+    unsigned long long completed = 0;
+
+    SC_HAS_PROCESS(MethodInitiator);
+    MethodInitiator(sc_core::sc_module_name name) : socket("socket") // Construct and name socket
+    {
+        // register method process, triggered once at initialization and then only by next_trigger
+        SC_METHOD(method_process);
+    }
+
+private:
+    enum State
+    {
+        GENERATE, // Pick the next command, address and data
+        ISSUE,    // Set up the payload and call b_transport
+        CHECK,    // Check the response, report, and schedule the next activation
+        DONE      // All transactions issued
+    };
+
+    State state = GENERATE;
+    unsigned int n = 0;                  // Index of the current transaction
+    int addr = 0;                        // Address of the current transaction
+    int data = 0;                        // Internal data buffer used by initiator with generic payload
+    tlm::tlm_command cmd = tlm::TLM_READ_COMMAND;
+    tlm::tlm_generic_payload trans;      // Reused across calls to b_transport
+    sc_time delay;                       // Delay annotated onto the current transaction
+    sc_time local_time = SC_ZERO_TIME;   // Time this initiator has run ahead of the kernel
+
+    void method_process()
+    {
+        // Run the state machine until it has to give time back to the kernel
+        while (true)
+        {
+            switch (state)
+            {
+            case GENERATE:
+                if (n == transactions)
+                {
+                    state = DONE;
+                    break;
+                }
+
+                // Addresses 32..92 as in Initiator::thread_process, wrapped around for longer runs
+                addr = 32 + (n * 4) % 64;
+                delay = sc_time(10, SC_NS);
+
+                cmd = static_cast<tlm::tlm_command>(rand() % 2);
+                if (cmd == tlm::TLM_WRITE_COMMAND)
+                    data = 0xFF000000 | addr;
+
+                state = ISSUE;
+                break;
+
+            case ISSUE:
+                trans.set_command(cmd);
+                trans.set_address(addr);
+                trans.set_data_ptr(reinterpret_cast<unsigned char *>(&data));
+                trans.set_data_length(size);
+                trans.set_streaming_width(size);                          // = data_length to indicate no streaming
+                trans.set_byte_enable_ptr(0);                             // 0 indicates unused
+                trans.set_dmi_allowed(false);                             // Mandatory initial value
+                trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE); // Mandatory initial value
+
+                socket->b_transport(trans, delay); // Blocking transport call, must not wait
+
+                state = CHECK;
+                break;
+
+            case CHECK:
+                // Initiator obliged to check response status and delay
+                if (trans.is_response_error())
+                {
+                    SC_REPORT_ERROR("TLM-2", "Response error from b_transport");
+                }
+
+                completed++;
+
+                if (verbose)
+                    cout << "trans = { " << (cmd ? 'W' : 'R') << ", " << hex << addr
+                         << " } , data = " << hex << data << " at time " << sc_time_stamp() + local_time
+                         << " delay = " << delay << endl;
+
+                if (trace)
+                    trace->writeRow((sc_time_stamp() + local_time).value(), (cmd ? 'W' : 'R'), addr, static_cast<unsigned int>(data), delay.value());
+
+                n++;
+                state = GENERATE;
+
+                // Realize the delay annotated onto the transport call, either now or once
+                // the accumulated local time reaches the quantum
+                if (quantum == SC_ZERO_TIME)
+                {
+                    next_trigger(delay);
+                    return;
+                }
+                local_time += delay;
+                if (local_time >= quantum)
+                {
+                    next_trigger(local_time);
+                    local_time = SC_ZERO_TIME;
+                    return;
+                }
+                break;
+
+            case DONE:
+                // Synchronize the remaining local time, then stay idle for good
+                if (local_time > SC_ZERO_TIME)
+                {
+                    next_trigger(local_time);
+                    local_time = SC_ZERO_TIME;
+                }
+                return;
+            }
+        }
+    }
+};
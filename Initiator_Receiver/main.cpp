@@ -3,28 +3,150 @@
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "cache.h"
 #include "initiator.h"
+#include "initiator_method.h"
 #include "memory.h"
+#include "sim_config.h"
 
 using namespace sc_core;
 using namespace sc_dt;
 using namespace std;
 
+// Create either initiator implementation with the run-time parameters applied
+template <typename INITIATOR>
+INITIATOR *createInitiator(const string &name, const SimConfig &config)
+{
+    INITIATOR *initiator = new INITIATOR(name.c_str());
+    initiator->transactions = config.transactions;
+    initiator->size = config.size;
+    initiator->quantum = sc_time(config.quantum_ns, SC_NS);
+    initiator->verbose = config.verbose;
+    return initiator;
+}
 
 int sc_main(int argc, char *argv[])
 {
-    Initiator *initiator;
-    Memory *memory;
+    SimConfig config;
+    if (!config.parse(argc, argv))
+        return 1;
+
+    srand(config.seed);
+
+    vector<Initiator *> threads;
+    vector<MethodInitiator *> methods;
+    vector<Memory *> memories;
+    vector<Cache *> caches;
+    vector<Unbatcher *> unbatchers;
+
+    // Instantiate components, one memory per initiator.
+    // A single pair keeps the original names "initiator" and "memory".
+    for (unsigned int k = 0; k < config.initiators; k++)
+    {
+        string suffix = config.initiators > 1 ? "_" + to_string(k) : "";
+        Memory *memory = new Memory(("memory" + suffix).c_str());
+        memory->latency = sc_time(config.latency_ns, SC_NS);
+        memories.push_back(memory);
 
-    // Instantiate components
-    initiator = new Initiator("initiator");
-    memory = new Memory("memory");
+        // One initiator is bound directly to one target with no intervening bus,
+        // or through its own cache when one is configured
+        Cache *cache = nullptr;
+        if (config.cache_bytes > 0)
+        {
+            cache = new Cache(("cache" + suffix).c_str(), config.cache_bytes, config.cache_line, config.cache_ways, config.write_back);
+            cache->initiator_socket.bind(memory->socket);
+            caches.push_back(cache);
+        }
 
-    // One initiator is bound directly to one target with no intervening bus
+        // The cache is not batch-aware, batches reach it through an Unbatcher
+        Unbatcher *unbatcher = nullptr;
+        if (config.unbatch || (config.batch > 1 && cache))
+        {
+            unbatcher = new Unbatcher(("unbatcher" + suffix).c_str());
+            if (cache)
+                unbatcher->initiator_socket.bind(cache->target_socket);
+            else
+                unbatcher->initiator_socket.bind(memory->socket);
+            unbatchers.push_back(unbatcher);
+        }
 
-    // Bind initiator socket to target socket
-    initiator->socket.bind(memory->socket);
+        // Bind initiator socket to target socket
+        if (config.initiator == "method")
+        {
+            methods.push_back(createInitiator<MethodInitiator>("initiator" + suffix, config));
+            if (unbatcher)
+                methods.back()->socket.bind(unbatcher->target_socket);
+            else if (cache)
+                methods.back()->socket.bind(cache->target_socket);
+            else
+                methods.back()->socket.bind(memory->socket);
+        }
+        else
+        {
+            threads.push_back(createInitiator<Initiator>("initiator" + suffix, config));
+            threads.back()->batch = config.batch;
+            if (unbatcher)
+                threads.back()->socket.bind(unbatcher->target_socket);
+            else if (cache)
+                threads.back()->socket.bind(cache->target_socket);
+            else
+                threads.back()->socket.bind(memory->socket);
+        }
+    }
 
+    // Optionally export every transaction of the first initiator to a CSV file
+    CsvWriter trace;
+    if (!config.trace.empty() && trace.open(config.trace, CsvWriter::DEFAULT_BUFFER_SIZE, true))
+    {
+        trace.writeHeader({"time_ps", "command", "address", "data", "delay_ps"});
+        if (!threads.empty())
+            threads[0]->trace = &trace;
+        else
+            methods[0]->trace = &trace;
+    }
+
+    auto wall_start = chrono::steady_clock::now();
     sc_start();
+    double wall_s = chrono::duration<double>(chrono::steady_clock::now() - wall_start).count();
+
+    trace.close();
+
+    // Write dirty lines back so that the memories hold the final contents.
+    // Fine outside a process because this Memory never waits in b_transport.
+    unsigned long long cache_hits = 0, cache_misses = 0, downstream = 0;
+    for (Cache *cache : caches)
+    {
+        sc_time delay = SC_ZERO_TIME;
+        cache->flush(delay);
+        if (config.verbose)
+            cache->print_statistics();
+        cache_hits += cache->hits;
+        cache_misses += cache->misses;
+        downstream += cache->downstream_transactions;
+    }
+
+    // Optionally summarize the run as a one-row CSV, merged by the ParameterSweep driver
+    if (!config.metrics.empty())
+    {
+        unsigned long long completed = 0;
+        for (Initiator *initiator : threads)
+            completed += initiator->completed;
+        for (MethodInitiator *initiator : methods)
+            completed += initiator->completed;
+
+        CsvWriter metrics;
+        if (!metrics.open(config.metrics))
+            return 1;
+        metrics.writeHeader({"initiator", "initiators", "transactions", "size", "latency_ns", "quantum_ns", "seed", "batch",
+                             "cache", "cache_line", "cache_ways", "write_back", "cache_hits", "cache_misses", "downstream_transactions",
+                             "completed", "sim_time_ps", "wall_s", "transactions_per_s"});
+        metrics.writeRow(config.initiator, config.initiators, config.transactions, config.size, config.latency_ns, config.quantum_ns, config.seed, config.batch,
+                         config.cache_bytes, config.cache_line, config.cache_ways, config.write_back ? 1 : 0, cache_hits, cache_misses, downstream,
+                         completed, sc_time_stamp().value(), wall_s, wall_s > 0 ? completed / wall_s : 0.0);
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
+#include "batch_extension.h"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -23,6 +24,9 @@ public:
     // TLM-2 socket, defaults to 32-bits wide, base protocol
     tlm_utils::simple_target_socket<Memory> socket;
 
+    // Access latency annotated onto every transaction, set before sc_start
+    sc_time latency = SC_ZERO_TIME;
+
     Memory(sc_core::sc_module_name name) : socket("socket")
     {
         // Register callback for incoming b_transport interface method call
@@ -43,26 +47,57 @@ public:
         unsigned char *byt = trans.get_byte_enable_ptr(); // Byte enables are used to specify which bytes in a data buffer are valid or should be modified during the transaction.
         unsigned int wid = trans.get_streaming_width();   // Streaming width is used in burst transfers to specify the number of bytes that can be transferred in a single burst
 
+        // A batch carries independent sub-transactions, all of them are processed in this one call
+        BatchExtension *batch = nullptr;
+        trans.get_extension(batch);
+        if (batch)
+        {
+            for (BatchEntry &entry : batch->entries)
+            {
+                if (entry.address + entry.length > sc_dt::uint64(SIZE) * 4)
+                {
+                    entry.response = tlm::TLM_ADDRESS_ERROR_RESPONSE;
+                    continue;
+                }
+
+                if (entry.command == tlm::TLM_READ_COMMAND)
+                    memcpy(entry.data, reinterpret_cast<unsigned char *>(mem) + entry.address, entry.length);
+                else if (entry.command == tlm::TLM_WRITE_COMMAND)
+                    memcpy(reinterpret_cast<unsigned char *>(mem) + entry.address, entry.data, entry.length);
+
+                delay += latency;
+                entry.latency = latency;
+                entry.response = tlm::TLM_OK_RESPONSE;
+            }
+
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            return;
+        }
+
         // Obliged to check address range and check for unsupported features,
-        //   i.e. byte enables, streaming, and bursts
+        //   i.e. byte enables and streaming
+        // Bursts are supported as long as they stay inside the memory (e.g. cache line fills)
         // Can ignore DMI hint and extensions
         // Using the SystemC report handler is an acceptable way of signalling an error
 
-        if (adr >= sc_dt::uint64(SIZE) || byt != 0 || len > 4 || wid < len)
+        if (adr >= sc_dt::uint64(SIZE) || byt != 0 || wid < len || trans.get_address() + len > sc_dt::uint64(SIZE) * 4)
             SC_REPORT_ERROR("TLM-2", "Target does not support given generic payload transaction");
 
         // Obliged to implement read and write commands
         if (cmd == tlm::TLM_READ_COMMAND)
         {
             // Read from memory
-            memcpy(ptr, &mem[adr], len);
+            memcpy(ptr, reinterpret_cast<unsigned char *>(mem) + trans.get_address(), len);
         }
         else if (cmd == tlm::TLM_WRITE_COMMAND)
         {
             // Store to memory
-            memcpy(&mem[adr], ptr, len);
+            memcpy(reinterpret_cast<unsigned char *>(mem) + trans.get_address(), ptr, len);
         }
 
+        // Annotate the access latency, the initiator realizes it
+        delay += latency;
+
         // Obliged to set response status to indicate successful completion
         trans.set_response_status(tlm::TLM_OK_RESPONSE);
     }
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+/// Run-time parameters of the example platform, parsed from "--name=value" arguments
+/// so that a design-space sweep can drive many runs without recompiling sc_main.
+
+struct SimConfig
+{
+    unsigned int initiators = 1;    // Number of independent initiator/memory pairs
+    unsigned int transactions = 16; // Transactions issued by each initiator
+    unsigned int size = 4;          // Bytes per transaction (1, 2 or 4)
+    unsigned int latency_ns = 0;    // Latency annotated by the memory on each access
+    unsigned int quantum_ns = 0;    // Initiator time quantum, 0 = synchronize after every transaction
+    unsigned int seed = 1;          // Seed for rand(), 1 is the C library default
+    bool verbose = true;            // Print every transaction to stdout
+    std::string initiator = "thread"; // Initiator implementation: "thread" (SC_THREAD) or "method" (SC_METHOD)
+    unsigned int cache_bytes = 0;   // Cache in front of each initiator, 0 = no cache
+    unsigned int cache_line = 16;   // Cache line size in bytes
+    unsigned int cache_ways = 2;    // Cache associativity
+    bool write_back = true;         // Write-back (true) or write-through (false) cache
+    unsigned int batch = 1;         // Transactions per b_transport call (thread initiator only)
+    bool unbatch = false;           // Put an Unbatcher in front of the target
+    std::string trace;              // Per-transaction CSV output (empty = disabled)
+    std::string metrics;            // One-row CSV summary of the run (empty = disabled)
+
+    // Parse the command line, returns false on an unknown or malformed argument
+    bool parse(int argc, char *argv[])
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+
+            // A bare argument is the trace file, as in earlier versions of this example
+            if (arg.compare(0, 2, "--") != 0)
+            {
+                trace = arg;
+                continue;
+            }
+
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos)
+            {
+                std::cerr << "Error: expected --name=value, got '" << arg << "'\n";
+                return false;
+            }
+            std::string name = arg.substr(2, eq - 2);
+            std::string value = arg.substr(eq + 1);
+            bool ok = true;
+
+            if (name == "initiators")
+                ok = toUnsigned(value, initiators);
+            else if (name == "transactions")
+                ok = toUnsigned(value, transactions);
+            else if (name == "size")
+                ok = toUnsigned(value, size);
+            else if (name == "latency")
+                ok = toUnsigned(value, latency_ns);
+            else if (name == "quantum")
+                ok = toUnsigned(value, quantum_ns);
+            else if (name == "seed")
+                ok = toUnsigned(value, seed);
+            else if (name == "verbose")
+                ok = toFlag(value, verbose);
+            else if (name == "cache")
+                ok = toUnsigned(value, cache_bytes);
+            else if (name == "cache_line")
+                ok = toUnsigned(value, cache_line);
+            else if (name == "cache_ways")
+                ok = toUnsigned(value, cache_ways);
+            else if (name == "write_back")
+                ok = toFlag(value, write_back);
+            else if (name == "batch")
+                ok = toUnsigned(value, batch);
+            else if (name == "unbatch")
+                ok = toFlag(value, unbatch);
+            else if (name == "initiator")
+                initiator = value;
+            else if (name == "trace")
+                trace = value;
+            else if (name == "metrics")
+                metrics = value;
+            else
+            {
+                std::cerr << "Error: unknown parameter '" << name << "'\n";
+                return false;
+            }
+
+            if (!ok)
+            {
+                std::cerr << "Error: malformed number '" << value << "' for parameter '" << name << "'\n";
+                return false;
+            }
+        }
+
+        if (initiators == 0 || (size != 1 && size != 2 && size != 4))
+        {
+            std::cerr << "Error: initiators must be > 0 and size one of 1, 2, 4\n";
+            return false;
+        }
+        if (initiator != "thread" && initiator != "method")
+        {
+            std::cerr << "Error: initiator must be 'thread' or 'method'\n";
+            return false;
+        }
+        if (cache_bytes > 0 && (cache_line == 0 || (cache_line & (cache_line - 1)) != 0 || cache_ways == 0 ||
+                                cache_bytes < cache_line * cache_ways))
+        {
+            std::cerr << "Error: cache_line must be a power of two, cache_ways > 0 and the cache must hold one set\n";
+            return false;
+        }
+        if (batch == 0 || (batch > 1 && initiator != "thread"))
+        {
+            std::cerr << "Error: batch must be > 0, batching is only supported by the thread initiator\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Strict number parsing, also used for the options of other drivers (SharedMemoryBridge).
+    // The whole value must be a number (decimal, 0x hex or 0 octal) that fits an unsigned int
+    static bool toUnsigned(const std::string &value, unsigned int &out)
+    {
+        if (value.empty() || value[0] == '-' || value[0] == '+' || isspace(static_cast<unsigned char>(value[0])))
+            return false;
+        char *end = nullptr;
+        errno = 0;
+        unsigned long n = std::strtoul(value.c_str(), &end, 0);
+        if (errno != 0 || *end != '\0' || n > std::numeric_limits<unsigned int>::max())
+            return false;
+        out = static_cast<unsigned int>(n);
+        return true;
+    }
+
+    static bool toFlag(const std::string &value, bool &out)
+    {
+        unsigned int n;
+        if (!toUnsigned(value, n))
+            return false;
+        out = n != 0;
+        return true;
+    }
+};
@@ -0,0 +1,273 @@
+// Parameter sweep driver
+//
+// A SystemC kernel is single-threaded per process, so a design-space sweep is run
+// as many independent simulation processes. Every combination of the given
+// parameter lists becomes one run of the simulator, at most --jobs (default: number
+// of host cores) runs execute at the same time, and the one-row metrics CSV written
+// by each run is merged into a single report.
+//
+// Usage:
+//   ParameterSweep --sim=<simulator> [--out=sweep.csv] [--jobs=N] [--workdir=dir]
+//                  name=v1,v2,... [name=v1,...]
+//
+// Example, with the Initiator_Receiver simulator:
+//   ParameterSweep --sim=../Initiator_Receiver/build/SystemC_Transmitter_Receiver
+//                  latency=0,10,20 quantum=0,100 initiators=1,4 transactions=100000
+
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CsvReader.hpp"
+#include "CsvWriter.hpp"
+
+extern char **environ;
+
+using namespace std;
+
+struct Parameter
+{
+    string name;
+    vector<string> values;
+};
+
+struct Run
+{
+    size_t index;
+    vector<string> args;  // "--name=value" for every swept parameter
+    vector<string> values; // Parameter values, in Parameter order
+    string metrics;        // Metrics CSV written by the run
+    string log;            // stdout/stderr of the run
+    int status = -1;       // Exit status, -1 if it did not exit normally
+    double wall_s = 0;     // Host time of the whole process
+};
+
+static vector<string> split(const string &text, char separator)
+{
+    vector<string> items;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, separator))
+        items.push_back(item);
+    return items;
+}
+
+// Expand the cartesian product of all parameter lists into runs
+static vector<Run> expand(const vector<Parameter> &parameters, const string &workdir)
+{
+    vector<Run> runs(1);
+    for (const auto &parameter : parameters)
+    {
+        vector<Run> next;
+        for (const auto &run : runs)
+        {
+            for (const auto &value : parameter.values)
+            {
+                Run r = run;
+                r.args.push_back("--" + parameter.name + "=" + value);
+                r.values.push_back(value);
+                next.push_back(r);
+            }
+        }
+        runs.swap(next);
+    }
+
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        runs[i].index = i;
+        runs[i].metrics = workdir + "/run_" + to_string(i) + ".csv";
+        runs[i].log = workdir + "/run_" + to_string(i) + ".log";
+    }
+    return runs;
+}
+
+// Launch one run as a worker process, its output redirected to the run log
+static pid_t launch(const string &sim, const Run &run)
+{
+    vector<string> args = {sim};
+    args.insert(args.end(), run.args.begin(), run.args.end());
+    args.push_back("--metrics=" + run.metrics);
+    args.push_back("--verbose=0");
+
+    vector<char *> argv;
+    for (auto &arg : args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, run.log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    pid_t pid = -1;
+    int err = posix_spawn(&pid, sim.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (err != 0)
+    {
+        cerr << "Error: Could not launch '" << sim << "' (" << strerror(err) << ")\n";
+        return -1;
+    }
+    return pid;
+}
+
+int main(int argc, char *argv[])
+{
+    string sim;
+    string out = "sweep.csv";
+    string workdir = "sweep_runs";
+    unsigned int jobs = thread::hardware_concurrency();
+    vector<Parameter> parameters;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == string::npos)
+        {
+            cerr << "Error: expected name=value, got '" << arg << "'\n";
+            return 1;
+        }
+        string name = arg.substr(0, eq);
+        string value = arg.substr(eq + 1);
+
+        if (name == "--sim")
+            sim = value;
+        else if (name == "--out")
+            out = value;
+        else if (name == "--jobs")
+        {
+            char *end = nullptr;
+            errno = 0;
+            unsigned long n = strtoul(value.c_str(), &end, 10);
+            if (value.empty() || !isdigit(static_cast<unsigned char>(value[0])) || errno != 0 || *end != '\0' ||
+                n > numeric_limits<unsigned int>::max())
+            {
+                cerr << "Error: malformed number '" << value << "' for --jobs\n";
+                return 1;
+            }
+            jobs = static_cast<unsigned int>(n);
+        }
+        else if (name == "--workdir")
+            workdir = value;
+        else
+        {
+            // An empty list would expand to no runs at all, an empty value to a meaningless one
+            vector<string> values = split(value, ',');
+            if (values.empty() || find(values.begin(), values.end(), "") != values.end() || value.back() == ',')
+            {
+                cerr << "Error: parameter '" << name << "' needs a list of non-empty values, got '" << value << "'\n";
+                return 1;
+            }
+            parameters.push_back({name, values});
+        }
+    }
+
+    if (sim.empty())
+    {
+        cerr << "Usage: " << argv[0] << " --sim=<simulator> [--out=sweep.csv] [--jobs=N] [--workdir=dir] name=v1,v2,...\n";
+        return 1;
+    }
+    if (jobs == 0)
+        jobs = 1;
+
+    mkdir(workdir.c_str(), 0755);
+
+    vector<Run> runs = expand(parameters, workdir);
+    cout << "Sweeping " << runs.size() << " runs on " << jobs << " parallel workers" << endl;
+
+    // Keep at most 'jobs' workers alive, start the next run whenever one exits
+    map<pid_t, size_t> running;
+    vector<chrono::steady_clock::time_point> started(runs.size());
+    size_t next = 0;
+    size_t done = 0;
+    auto sweep_start = chrono::steady_clock::now();
+
+    while (done < runs.size())
+    {
+        while (next < runs.size() && running.size() < jobs)
+        {
+            started[next] = chrono::steady_clock::now();
+            pid_t pid = launch(sim, runs[next]);
+            if (pid > 0)
+                running[pid] = next;
+            else
+                done++;
+            next++;
+        }
+
+        if (running.empty())
+            continue;
+
+        int wstatus = 0;
+        pid_t pid = waitpid(-1, &wstatus, 0);
+        auto it = running.find(pid);
+        if (pid < 0 || it == running.end())
+            continue;
+
+        Run &run = runs[it->second];
+        run.status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+        run.wall_s = chrono::duration<double>(chrono::steady_clock::now() - started[run.index]).count();
+        running.erase(it);
+        done++;
+
+        cout << "[" << done << "/" << runs.size() << "] run " << run.index << " exit " << run.status
+             << " in " << run.wall_s << " s" << endl;
+    }
+
+    // Merge the per-run metrics: run columns first, then the simulator's own metrics
+    CsvWriter report;
+    if (!report.open(out))
+        return 1;
+
+    vector<string> header = {"run", "exit_status", "process_wall_s"};
+    for (const auto &parameter : parameters)
+        header.push_back(parameter.name);
+
+    vector<CsvReader> metrics(runs.size());
+    for (const auto &run : runs)
+    {
+        if (run.status == 0 && metrics[run.index].readCsv(run.metrics) && header.size() == 3 + parameters.size())
+        {
+            const auto &columns = metrics[run.index].getTableHeader();
+            header.insert(header.end(), columns.begin(), columns.end());
+        }
+    }
+    report.writeHeader(header);
+
+    size_t failed = 0;
+    for (const auto &run : runs)
+    {
+        if (run.status != 0)
+            failed++;
+
+        report.writeField(run.index);
+        report.writeField(run.status);
+        report.writeField(run.wall_s);
+        for (const auto &value : run.values)
+            report.writeField(value);
+        for (size_t col = 0; col < metrics[run.index].getTotalColumns(); col++)
+            report.writeField(metrics[run.index].getCellValue(0, col));
+        report.endRow();
+    }
+    report.close();
+
+    double sweep_s = chrono::duration<double>(chrono::steady_clock::now() - sweep_start).count();
+    cout << "Sweep completed in " << sweep_s << " s, " << failed << " failed run(s), report: " << out << endl;
+    return failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/multi_passthrough_target_socket.h"
+
+#include <vector>
+
+#include "profiler.hpp"
+
+// Target module representing a multi-port memory built from address-interleaved banks
+
+class BankedMemory : sc_module
+{
+public:
+    enum
+    {
+        SIZE = 256,      // Memory size in words, as Memory
+        INTERLEAVE = 64  // Bytes of consecutive addresses mapped to the same bank
+    };
+
+    /**
+     * Any number of initiators can bind to the same multi-port socket. Each transaction
+     * arrives with the index of its port, so masters are not funnelled through one socket
+     * and accesses to different banks proceed in parallel.
+     */
+    tlm_utils::multi_passthrough_target_socket<BankedMemory> socket;
+
+    // Per-bank timing and statistics
+    struct Bank
+    {
+        vector<unsigned char> data;      // Backing store, INTERLEAVE-byte blocks of this bank back to back
+        sc_time latency;                 // Access latency
+        sc_time busy_until;              // The bank serves one access at a time
+        unsigned long long accesses = 0;
+        unsigned long long conflicts = 0; // Accesses that found the bank busy
+        sc_time conflict_delay;           // Total time spent waiting for the bank
+    };
+
+    vector<Bank> banks;
+
+    // Per-port statistics
+    vector<unsigned long long> port_accesses;
+
+    SC_HAS_PROCESS(BankedMemory);
+    BankedMemory(sc_core::sc_module_name name, unsigned int num_banks = 4, sc_time latency = sc_time(10, SC_NS))
+        : socket("socket"), banks(num_banks)
+    {
+        // Register callbacks for incoming interface method calls, with the port index
+        socket.register_b_transport(this, &BankedMemory::b_transport);
+        socket.register_get_direct_mem_ptr(this, &BankedMemory::get_direct_mem_ptr);
+        socket.register_transport_dbg(this, &BankedMemory::transport_dbg);
+
+        unsigned int blocks = SIZE * 4 / INTERLEAVE;
+        for (Bank &bank : banks)
+        {
+            bank.data.resize(((blocks + num_banks - 1) / num_banks) * INTERLEAVE);
+            bank.latency = latency;
+            bank.busy_until = SC_ZERO_TIME;
+            bank.conflict_delay = SC_ZERO_TIME;
+        }
+
+        // Initialize memory with random data, word by word as Memory does
+        for (unsigned int adr = 0; adr < SIZE * 4; adr += 4)
+        {
+            int word = 0xAA000000 | (rand() % 256);
+            memcpy(byte_ptr(adr), &word, 4);
+        }
+
+        // Profiling probes, null unless SC_PROFILE is set
+        string socket_name = string(this->name()) + ".socket.";
+        prof_b_transport = Profiler::instance().probe(socket_name + "b_transport", "callback");
+        prof_get_direct_mem_ptr = Profiler::instance().probe(socket_name + "get_direct_mem_ptr", "callback");
+        prof_transport_dbg = Profiler::instance().probe(socket_name + "transport_dbg", "callback");
+    }
+
+    void print_statistics() const
+    {
+        for (size_t b = 0; b < banks.size(); b++)
+            cout << name() << ".bank" << b << ": " << dec << banks[b].accesses << " accesses, "
+                 << banks[b].conflicts << " conflicts, " << banks[b].conflict_delay << " waiting" << endl;
+        for (size_t p = 0; p < port_accesses.size(); p++)
+            cout << name() << ".port" << p << ": " << dec << port_accesses[p] << " accesses" << endl;
+    }
+
+private:
+    unsigned int bank_of(sc_dt::uint64 adr) const
+    {
+        return (adr / INTERLEAVE) % banks.size();
+    }
+
+    // Location of a byte address inside the backing store of its bank
+    unsigned char *byte_ptr(sc_dt::uint64 adr)
+    {
+        sc_dt::uint64 block = adr / INTERLEAVE;
+        Bank &bank = banks[block % banks.size()];
+        return &bank.data[(block / banks.size()) * INTERLEAVE + adr % INTERLEAVE];
+    }
+
+    /**
+     * @brief TLM-2 blocking transport method
+     * Same checks and error responses as Memory, plus the timing of the addressed bank:
+     * an access that finds its bank busy waits until the bank is free.
+     */
+    virtual void b_transport(int port, tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        Profiler::Scope profile(prof_b_transport);
+
+        tlm::tlm_command cmd = trans.get_command();
+        sc_dt::uint64 adr = trans.get_address();
+        unsigned char *ptr = trans.get_data_ptr();
+        unsigned int len = trans.get_data_length();
+        unsigned char *byt = trans.get_byte_enable_ptr();
+        unsigned int wid = trans.get_streaming_width();
+
+        if (adr >= sc_dt::uint64(SIZE) * 4)
+        {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+        }
+        if (byt != 0)
+        {
+            trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+        // A transaction must stay inside one interleave block, i.e. one bank
+        if (len > 4 || wid < len || adr % INTERLEAVE + len > INTERLEAVE)
+        {
+            trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+            return;
+        }
+
+        if (port_accesses.size() <= size_t(port))
+            port_accesses.resize(port + 1);
+        port_accesses[port]++;
+
+        // Bank timing: start when both the request and the bank are ready
+        Bank &bank = banks[bank_of(adr)];
+        sc_time request_time = sc_time_stamp() + delay;
+        sc_time start = request_time;
+        if (bank.busy_until > request_time)
+        {
+            start = bank.busy_until;
+            bank.conflicts++;
+            bank.conflict_delay += start - request_time;
+        }
+        bank.busy_until = start + bank.latency;
+        bank.accesses++;
+        delay += (start - request_time) + bank.latency;
+
+        if (cmd == tlm::TLM_READ_COMMAND)
+            memcpy(ptr, byte_ptr(adr), len);
+        else if (cmd == tlm::TLM_WRITE_COMMAND)
+            memcpy(byte_ptr(adr), ptr, len);
+
+        // Like Memory, realize the delay here; initiators on other banks keep running meanwhile
+        Profiler::instance().wait(delay);
+        delay = SC_ZERO_TIME;
+
+        trans.set_dmi_allowed(true);
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    /**
+     * @brief TLM-2 forward DMI method
+     * DMI is granted per bank: the region is the interleave block holding the address,
+     * which is contiguous in the backing store of its bank. DMI accesses bypass the bank
+     * conflict tracking and are charged the bank latency only.
+     */
+    virtual bool get_direct_mem_ptr(int port, tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data)
+    {
+        Profiler::Scope profile(prof_get_direct_mem_ptr);
+
+        sc_dt::uint64 adr = trans.get_address();
+        sc_dt::uint64 block_start = adr - adr % INTERLEAVE;
+
+        if (adr >= sc_dt::uint64(SIZE) * 4)
+            return false;
+
+        Bank &bank = banks[bank_of(adr)];
+        dmi_data.allow_read_write();
+        dmi_data.set_dmi_ptr(byte_ptr(block_start));
+        dmi_data.set_start_address(block_start);
+        dmi_data.set_end_address(block_start + INTERLEAVE - 1);
+        dmi_data.set_read_latency(bank.latency);
+        dmi_data.set_write_latency(bank.latency);
+
+        return true;
+    }
+
+    // TLM-2 debug transport method, may span several banks
+    virtual unsigned int transport_dbg(int port, tlm::tlm_generic_payload &trans)
+    {
+        Profiler::Scope profile(prof_transport_dbg);
+
+        tlm::tlm_command cmd = trans.get_command();
+        sc_dt::uint64 adr = trans.get_address();
+        unsigned char *ptr = trans.get_data_ptr();
+        unsigned int len = trans.get_data_length();
+
+        if (adr >= sc_dt::uint64(SIZE) * 4)
+            return 0;
+
+        // Calculate the number of bytes to be actually copied
+        unsigned int num_bytes = (len < SIZE * 4 - adr) ? len : SIZE * 4 - adr;
+
+        for (unsigned int done = 0; done < num_bytes;)
+        {
+            unsigned int chunk = INTERLEAVE - (adr + done) % INTERLEAVE;
+            if (chunk > num_bytes - done)
+                chunk = num_bytes - done;
+
+            if (cmd == tlm::TLM_READ_COMMAND)
+                memcpy(ptr + done, byte_ptr(adr + done), chunk);
+            else if (cmd == tlm::TLM_WRITE_COMMAND)
+                memcpy(byte_ptr(adr + done), ptr + done, chunk);
+            done += chunk;
+        }
+
+        return num_bytes;
+    }
+
+    Profiler::Probe *prof_b_transport;
+    Profiler::Probe *prof_get_direct_mem_ptr;
+    Profiler::Probe *prof_transport_dbg;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include <vector>
+
+/**
+ * @brief DRAM bank/row-buffer timing model
+ * Replaces the flat access latency of Memory with the latency of a DRAM access:
+ *   row hit      (row already open in its bank)        tCAS
+ *   row miss     (bank precharged, no open row)         tRCD + tCAS
+ *   row conflict (another row open in the bank)         tRP + tRCD + tCAS
+ * All banks are refreshed for tRFC at the end of every tREFI: an access falling into
+ * a refresh window stalls until its end, and refresh closes all open rows.
+ *
+ * The state update per access is constant time: a few integer operations on the
+ * addressed bank, no queues and no per-cycle simulation.
+ */
+class DramTiming
+{
+public:
+    struct Params
+    {
+        unsigned int banks = 4;         // Number of banks
+        unsigned int row_bytes = 64;    // Bytes per row, consecutive rows go to consecutive banks
+        sc_time tCAS = sc_time(14, SC_NS);
+        sc_time tRCD = sc_time(14, SC_NS);
+        sc_time tRP = sc_time(14, SC_NS);
+        sc_time tREFI = sc_time(7800, SC_NS); // Refresh interval
+        sc_time tRFC = sc_time(350, SC_NS);   // Refresh duration
+    };
+
+    struct BankStats
+    {
+        unsigned long long row_hits = 0;
+        unsigned long long row_misses = 0;
+        unsigned long long row_conflicts = 0;
+        unsigned long long refresh_stalls = 0;
+    };
+
+    DramTiming(const Params &params) : params(params), banks(params.banks), stats(params.banks)
+    {
+    }
+
+    DramTiming() : DramTiming(Params())
+    {
+    }
+
+    /**
+     * @brief Latency of an access at byte address 'adr' issued at time 'now'
+     * Updates the row-buffer state of the addressed bank.
+     */
+    sc_time access(sc_dt::uint64 adr, const sc_time &now)
+    {
+        sc_dt::uint64 row_index = adr / params.row_bytes;
+        unsigned int b = row_index % params.banks;
+        sc_dt::uint64 row = row_index / params.banks;
+        Bank &bank = banks[b];
+        BankStats &stat = stats[b];
+
+        sc_time latency = SC_ZERO_TIME;
+
+        // Refresh occupies the last tRFC of every tREFI interval. An access falling into it
+        // stalls until the interval ends, and rows opened in an earlier interval are closed.
+        sc_dt::uint64 t = now.value();
+        sc_dt::uint64 interval = params.tREFI.value();
+        sc_dt::uint64 window = t / interval;
+        sc_dt::uint64 phase = t % interval;
+        if (phase >= interval - params.tRFC.value())
+        {
+            latency += sc_time::from_value(interval - phase);
+            stat.refresh_stalls++;
+            window++;
+        }
+        if (bank.open && bank.refresh_window != window)
+            bank.open = false;
+        bank.refresh_window = window;
+
+        if (bank.open && bank.row == row)
+        {
+            latency += params.tCAS;
+            stat.row_hits++;
+        }
+        else if (!bank.open)
+        {
+            latency += params.tRCD + params.tCAS;
+            stat.row_misses++;
+        }
+        else
+        {
+            latency += params.tRP + params.tRCD + params.tCAS;
+            stat.row_conflicts++;
+        }
+
+        bank.open = true;
+        bank.row = row;
+
+        total_latency += latency;
+        accesses++;
+        return latency;
+    }
+
+    /**
+     * @brief Latency to advertise with a DMI grant
+     * DMI accesses bypass the model, so they are charged the mean latency observed so far
+     * (the row-miss latency before the first access).
+     */
+    sc_time dmi_latency() const
+    {
+        if (accesses == 0)
+            return params.tRCD + params.tCAS;
+        return total_latency / double(accesses);
+    }
+
+    const BankStats &bank_stats(unsigned int bank) const
+    {
+        return stats[bank];
+    }
+
+    void print_statistics(const char *name) const
+    {
+        for (unsigned int b = 0; b < params.banks; b++)
+            cout << name << ".dram.bank" << b << ": " << dec << stats[b].row_hits << " row hits, "
+                 << stats[b].row_misses << " row misses, " << stats[b].row_conflicts << " row conflicts, "
+                 << stats[b].refresh_stalls << " refresh stalls" << endl;
+        cout << name << ".dram: mean latency " << dmi_latency() << endl;
+    }
+
+private:
+    struct Bank
+    {
+        bool open = false;             // A row is open in the row buffer
+        sc_dt::uint64 row = 0;         // The open row
+        sc_dt::uint64 refresh_window = 0;
+    };
+
+    const Params params;
+    vector<Bank> banks;
+    vector<BankStats> stats;
+    sc_time total_latency = SC_ZERO_TIME;
+    unsigned long long accesses = 0;
+};
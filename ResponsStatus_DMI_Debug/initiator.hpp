@@ -9,6 +9,8 @@ using namespace std;
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 
+#include "profiler.hpp"
+
 // Initiator module generating generic payload transactions
 class Initiator : sc_module
 {
@@ -16,6 +18,9 @@ public:
     // TLM-2 socket, defaults to 32-bits wide, base protocol
     tlm_utils::simple_initiator_socket<Initiator> socket;
 
+    // Issue reads only, e.g. when the target is a ROM; set before sc_start
+    bool read_only = false;
+
     SC_CTOR(Initiator)
         : socket("socket"), // Construct and name socket
           dmi_ptr_valid(false)
@@ -28,30 +33,57 @@ public:
         socket.register_invalidate_direct_mem_ptr(this, &Initiator::invalidate_direct_mem_ptr);
 
         SC_THREAD(thread_process);
+
+        // Profiling probes, null unless SC_PROFILE is set
+        prof_invalidate_direct_mem_ptr = Profiler::instance().probe(string(name()) + ".socket.invalidate_direct_mem_ptr", "callback");
+        Profiler::instance().init_process(prof_thread_process, string(name()) + ".thread_process");
     }
 
     /**
      * @brief TLM-2 backward DMI method
      * The initiator must implement the invalidate_direct_mem_ptr method to wipe any existing pointers
      * as requested by the target from time-to-time, and register this method with the simple initiator socket.
-     * In this case the initiator ignores the bounds of the direct memory region, and simply invalidates the DMI pointer whatever
+     * The pointer is only wiped when its region overlaps the invalidated range, so that the target
+     * can revoke a few pages without pushing the initiator off the fast path for the rest of the memory.
      * @param start_range
      * @param end_range
      */
     virtual void invalidate_direct_mem_ptr(sc_dt::uint64 start_range,
                                            sc_dt::uint64 end_range)
     {
-        // Ignore range and invalidate all DMI pointers regardless
-        dmi_ptr_valid = false;
+        Profiler::Scope profile(prof_invalidate_direct_mem_ptr);
+
+        if (start_range <= dmi_data.get_end_address() && end_range >= dmi_data.get_start_address())
+            dmi_ptr_valid = false;
+    }
+
+    /**
+     * @brief Debug read of the target, e.g. to digest the memory contents after the simulation
+     * Uses the debug transport interface, so it has no side-effects and can be called outside processes.
+     * @return the number of bytes actually read
+     */
+    unsigned int debug_read(sc_dt::uint64 address, unsigned char *data, unsigned int len)
+    {
+        tlm::tlm_generic_payload trans;
+        trans.set_address(address);
+        trans.set_read();
+        trans.set_data_length(len);
+        trans.set_data_ptr(data);
+        return socket->transport_dbg(trans);
     }
 
 private:
     bool dmi_ptr_valid;
     tlm::tlm_dmi dmi_data;
 
+    Profiler::Probe *prof_invalidate_direct_mem_ptr;
+    Profiler::Process prof_thread_process;
+
 protected:
     void thread_process()
     {
+        Profiler::ProcessScope profile(prof_thread_process);
+
         // TLM-2 generic payload transaction, reused across calls to b_transport, DMI and debug
         tlm::tlm_generic_payload *trans = new tlm::tlm_generic_payload;
         sc_time delay = sc_time(10, SC_NS);
@@ -61,26 +93,32 @@ protected:
         {
             int data;
             tlm::tlm_command cmd = static_cast<tlm::tlm_command>(rand() % 2);
+            if (read_only)
+                cmd = tlm::TLM_READ_COMMAND;
             if (cmd == tlm::TLM_WRITE_COMMAND)
                 data = 0xFF000000 | i;
 
-            // Use DMI if it is available, reusing same transaction object
-            if (dmi_ptr_valid)
+            // Use DMI if it is available, covers the address and grants this kind of access
+            // (e.g. a ROM grants read-only DMI), reusing same transaction object
+            bool dmi_access_allowed = (cmd == tlm::TLM_READ_COMMAND) ? dmi_data.is_read_allowed() : dmi_data.is_write_allowed();
+            if (dmi_ptr_valid && dmi_access_allowed &&
+                sc_dt::uint64(i) >= dmi_data.get_start_address() && sc_dt::uint64(i) + 3 <= dmi_data.get_end_address())
             {
                 // Bypass transport interface and use direct memory interface
+                unsigned char *dmi_ptr = dmi_data.get_dmi_ptr() + (i - dmi_data.get_start_address());
 
                 // Implement target latency
                 if (cmd == tlm::TLM_READ_COMMAND)
                 {
                     assert(dmi_data.is_read_allowed());
-                    memcpy(&data, dmi_data.get_dmi_ptr() + i, 4);
-                    wait(dmi_data.get_read_latency());
+                    memcpy(&data, dmi_ptr, 4);
+                    Profiler::instance().wait(dmi_data.get_read_latency());
                 }
                 else if (cmd == tlm::TLM_WRITE_COMMAND)
                 {
                     assert(dmi_data.is_write_allowed());
-                    memcpy(dmi_data.get_dmi_ptr() + i, &data, 4);
-                    wait(dmi_data.get_write_latency());
+                    memcpy(dmi_ptr, &data, 4);
+                    Profiler::instance().wait(dmi_data.get_write_latency());
                 }
 
                 cout << "DMI   = { " << (cmd ? 'W' : 'R') << ", " << hex << i
@@ -9,6 +9,11 @@ using namespace std;
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 
+#include <bitset>
+
+#include "profiler.hpp"
+#include "dram_timing.hpp"
+
 // Target module representing a simple memory
 
 class Memory : sc_module
@@ -16,7 +21,10 @@ class Memory : sc_module
 public:
     enum
     {
-        SIZE = 256
+        SIZE = 256,                      // Memory size in words
+        PAGE_WORDS = 8,                  // Words per page, the granularity of DMI tracking
+        PAGE_BYTES = PAGE_WORDS * 4,     // Bytes per page
+        NUM_PAGES = SIZE / PAGE_WORDS    // Number of pages
     };
 
     // TLM-2 socket, defaults to 32-bits wide, base protocol
@@ -25,6 +33,9 @@ public:
 
     const sc_time LATENCY;
 
+    // Optional DRAM timing model, nullptr = flat LATENCY for DMI and the caller's delay for b_transport
+    DramTiming *dram = nullptr;
+
     SC_CTOR(Memory)
         : socket("socket"), LATENCY(10, SC_NS)
     {
@@ -38,6 +49,73 @@ public:
             mem[i] = 0xAA000000 | (rand() % 256);
 
         SC_THREAD(invalidation_process);
+
+        // Profiling probes, null unless SC_PROFILE is set
+        string socket_name = string(name()) + ".socket.";
+        prof_b_transport = Profiler::instance().probe(socket_name + "b_transport", "callback");
+        prof_get_direct_mem_ptr = Profiler::instance().probe(socket_name + "get_direct_mem_ptr", "callback");
+        prof_transport_dbg = Profiler::instance().probe(socket_name + "transport_dbg", "callback");
+        Profiler::instance().init_process(prof_invalidation_process, string(name()) + ".invalidation_process");
+    }
+
+    /**
+     * @brief Mark pages [first_page, last_page] as watched
+     * Accesses to watched pages (e.g. pages being remapped or protected) must go through b_transport
+     * so that the target sees them, hence DMI is revoked for them. Only the pages that are currently
+     * granted through DMI are invalidated; the rest of the memory stays on the fast path.
+     */
+    void watch_pages(unsigned int first_page, unsigned int last_page)
+    {
+        for (unsigned int page = first_page; page <= last_page && page < NUM_PAGES; page++)
+            watched.set(page);
+
+        // Invalidate each contiguous run of granted pages inside the range
+        unsigned int page = first_page;
+        while (page <= last_page && page < NUM_PAGES)
+        {
+            if (!granted[page])
+            {
+                page++;
+                continue;
+            }
+
+            // Grants are read/write and DMI writes are invisible to us, so a revoked page
+            // keeps counting as dirty until the next clear_dirty()
+            unsigned int run_start = page;
+            while (page <= last_page && page < NUM_PAGES && granted[page])
+            {
+                dirty.set(page);
+                granted.reset(page++);
+            }
+
+            socket->invalidate_direct_mem_ptr(run_start * PAGE_BYTES, page * PAGE_BYTES - 1);
+        }
+    }
+
+    /**
+     * @brief Release watched pages [first_page, last_page]
+     * Nothing needs to be invalidated: the DMI hint of the next b_transport to these pages
+     * tells the initiator that it can request DMI again.
+     */
+    void unwatch_pages(unsigned int first_page, unsigned int last_page)
+    {
+        for (unsigned int page = first_page; page <= last_page && page < NUM_PAGES; page++)
+            watched.reset(page);
+    }
+
+    /**
+     * @brief Whether a page may have been modified since the last clear_dirty()
+     * Writes through DMI are invisible to the target, so a page with an outstanding
+     * read/write DMI grant is conservatively considered dirty.
+     */
+    bool is_dirty(unsigned int page) const
+    {
+        return dirty[page] || granted[page];
+    }
+
+    void clear_dirty()
+    {
+        dirty.reset();
     }
 
 private:
@@ -49,6 +127,8 @@ private:
      */
     virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
     {
+        Profiler::Scope profile(prof_b_transport);
+
         tlm::tlm_command cmd = trans.get_command();
         sc_dt::uint64 adr = trans.get_address() / 4;
         unsigned char *ptr = trans.get_data_ptr();
@@ -100,10 +180,17 @@ private:
         if (cmd == tlm::TLM_READ_COMMAND)
             memcpy(ptr, &mem[adr], len);
         else if (cmd == tlm::TLM_WRITE_COMMAND)
+        {
             memcpy(&mem[adr], ptr, len);
+            dirty.set(adr / PAGE_WORDS);
+        }
+
+        // Add the latency of this access according to the bank/row-buffer state
+        if (dram)
+            delay += dram->access(trans.get_address(), sc_time_stamp() + delay);
 
         // Illustrates that b_transport may block
-        wait(delay);
+        Profiler::instance().wait(delay);
 
         // Reset timing annotation after waiting
         delay = SC_ZERO_TIME;
@@ -119,7 +206,7 @@ private:
          * making repeated calls to get_direct_mem_ptr if it can be told in advance that such calls are going to fail.
          * Hence the b_transport method in our example makes the following call to set the DMI hint
          */
-        trans.set_dmi_allowed(true);
+        trans.set_dmi_allowed(!watched[adr / PAGE_WORDS]);
 
         // Obliged to set response status to indicate successful completion
         trans.set_response_status(tlm::TLM_OK_RESPONSE);
@@ -140,6 +227,8 @@ private:
     virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans,
                                     tlm::tlm_dmi &dmi_data)
     {
+        Profiler::Scope profile(prof_get_direct_mem_ptr);
+
         /**
          * The target (in this example is Memory) must decide whether or not it can grant the kind of access being requested,
          * and may even grant a higher level of access than requested.
@@ -151,29 +240,64 @@ private:
 
         // The target must now populate the DMI data object to describe the details of the access being given.
 
+        sc_dt::uint64 page = trans.get_address() / PAGE_BYTES;
+        if (page >= NUM_PAGES || watched[page])
+        {
+            // No DMI for this page, tell the initiator which range is excluded
+            dmi_data.allow_none();
+            dmi_data.set_start_address(page * PAGE_BYTES);
+            dmi_data.set_end_address(page * PAGE_BYTES + PAGE_BYTES - 1);
+            return false;
+        }
+
+        // Grant the largest run of unwatched pages around the requested address
+        unsigned int first = page, last = page;
+        while (first > 0 && !watched[first - 1])
+            first--;
+        while (last + 1 < NUM_PAGES && !watched[last + 1])
+            last++;
+
+        // Record ownership, so that only granted pages are invalidated later
+        for (unsigned int p = first; p <= last; p++)
+            granted.set(p);
+
         // Permit read and write access
         dmi_data.allow_read_write();
 
-        // Set other details of DMI region
-        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char *>(&mem[0]));
-        dmi_data.set_start_address(0);
-        dmi_data.set_end_address(SIZE * 4 - 1);
-        dmi_data.set_read_latency(LATENCY);
-        dmi_data.set_write_latency(LATENCY);
+        // Set other details of DMI region, the end address is a byte address
+        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char *>(&mem[first * PAGE_WORDS]));
+        dmi_data.set_start_address(first * PAGE_BYTES);
+        dmi_data.set_end_address((last + 1) * PAGE_BYTES - 1);
+        dmi_data.set_read_latency(dram ? dram->dmi_latency() : LATENCY);
+        dmi_data.set_write_latency(dram ? dram->dmi_latency() : LATENCY);
 
         return true;
     }
 
     void invalidation_process()
     {
-        // Invalidate DMI pointers periodically
+        Profiler::ProcessScope profile(prof_invalidation_process);
+
+        // Watch a different page for a while every few accesses, e.g. while it is being remapped.
+        // Only that page is revoked (and only if it was granted), the rest stays on DMI.
         for (int i = 0; i < 4; i++)
         {
-            wait(LATENCY * 8);
-            socket->invalidate_direct_mem_ptr(0, SIZE - 1);
+            Profiler::instance().wait(LATENCY * 8);
+            watch_pages(i + 1, i + 1);
+            Profiler::instance().wait(LATENCY * 4);
+            unwatch_pages(i + 1, i + 1);
         }
     }
 
+    std::bitset<NUM_PAGES> granted; // Pages covered by an outstanding DMI grant (ownership)
+    std::bitset<NUM_PAGES> dirty;   // Pages written through b_transport, or revoked from DMI, since the last clear_dirty()
+    std::bitset<NUM_PAGES> watched; // Pages that must not be accessed through DMI
+
+    Profiler::Probe *prof_b_transport;
+    Profiler::Probe *prof_get_direct_mem_ptr;
+    Profiler::Probe *prof_transport_dbg;
+    Profiler::Process prof_invalidation_process;
+
     /**
      * @brief TLM-2 debug transport method
      * The purpose of the debug transport interface is to give an initiator the ability to read or write memory
@@ -190,6 +314,8 @@ private:
      */
     virtual unsigned int transport_dbg(tlm::tlm_generic_payload &trans)
     {
+        Profiler::Scope profile(prof_transport_dbg);
+
         tlm::tlm_command cmd = trans.get_command();
         sc_dt::uint64 adr = trans.get_address() / 4;
         unsigned char *ptr = trans.get_data_ptr();
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Per-page hashes of a memory image, for fast regression checks
+ * Instead of dumping every word and diffing text, a run records one 64-bit hash per page.
+ * Two digests (two runs, or a run and a golden file) are compared page by page and only
+ * the differing address ranges are reported.
+ *
+ * The hash is not cryptographic. It processes 32-byte stripes in four independent 64-bit
+ * lanes using 32x32->64 bit multiplies, a form compilers map onto SIMD multiply
+ * instructions (SSE2/AVX2 pmuludq, NEON umull), so hashing runs near memory bandwidth.
+ */
+class MemoryDigest
+{
+public:
+    // Inclusive byte range [first, second]
+    typedef std::pair<uint64_t, uint64_t> Range;
+
+    uint64_t page_size = 4096;
+    uint64_t total_bytes = 0;
+    std::vector<uint64_t> hashes;
+
+    static MemoryDigest compute(const unsigned char *data, uint64_t len, uint64_t page_size = 4096)
+    {
+        MemoryDigest digest;
+        digest.page_size = page_size;
+        digest.total_bytes = len;
+        for (uint64_t offset = 0; offset < len; offset += page_size)
+        {
+            uint64_t n = (len - offset < page_size) ? len - offset : page_size;
+            digest.hashes.push_back(hash(data + offset, n));
+        }
+        return digest;
+    }
+
+    // Digest file: "page_size total_bytes" on the first line, then one hex hash per page
+    bool save(const std::string &filename) const
+    {
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open the file '" << filename << "'\n";
+            return false;
+        }
+        file << page_size << " " << total_bytes << "\n"
+             << std::hex << std::setfill('0');
+        for (uint64_t h : hashes)
+            file << std::setw(16) << h << "\n";
+        return true;
+    }
+
+    bool load(const std::string &filename)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open the file '" << filename << "'\n";
+            return false;
+        }
+        hashes.clear();
+        file >> page_size >> total_bytes >> std::hex;
+        uint64_t h;
+        while (file >> h)
+            hashes.push_back(h);
+        return page_size != 0 && hashes.size() == (total_bytes + page_size - 1) / page_size;
+    }
+
+    // Byte ranges whose pages differ, adjacent pages merged. A different page size or
+    // memory size makes the whole (larger) memory differ.
+    static std::vector<Range> diff(const MemoryDigest &a, const MemoryDigest &b)
+    {
+        std::vector<Range> ranges;
+        if (a.page_size != b.page_size || a.total_bytes != b.total_bytes)
+        {
+            uint64_t total = a.total_bytes > b.total_bytes ? a.total_bytes : b.total_bytes;
+            if (total > 0)
+                ranges.push_back(Range(0, total - 1));
+            return ranges;
+        }
+
+        for (uint64_t page = 0; page < a.hashes.size(); page++)
+        {
+            if (a.hashes[page] == b.hashes[page])
+                continue;
+
+            uint64_t first = page * a.page_size;
+            uint64_t last = std::min(first + a.page_size, a.total_bytes) - 1;
+            if (!ranges.empty() && ranges.back().second + 1 == first)
+                ranges.back().second = last;
+            else
+                ranges.push_back(Range(first, last));
+        }
+        return ranges;
+    }
+
+    static void print(std::ostream &os, const std::vector<Range> &ranges)
+    {
+        for (const Range &range : ranges)
+            os << "  differs: [0x" << std::hex << range.first << ", 0x" << range.second << "]" << std::dec << "\n";
+    }
+
+    static uint64_t hash(const unsigned char *data, uint64_t len)
+    {
+        static const uint64_t SECRET[4] = {0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL,
+                                           0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL};
+        uint64_t acc[4] = {PRIME1, PRIME2, PRIME3, PRIME4};
+
+        // Stripes of 4 lanes: the loop body has no cross-lane dependency, so it vectorizes.
+        // The key also depends on the stripe index, otherwise swapping two stripes (or two words
+        // at the same lane offset in different stripes) would leave the sums, hence the hash, unchanged.
+        uint64_t stripes = len / 32;
+        for (uint64_t s = 0; s < stripes; s++)
+        {
+            const unsigned char *p = data + s * 32;
+            uint64_t stripe_key = (s + 1) * PRIME3;
+            for (int lane = 0; lane < 4; lane++)
+            {
+                uint64_t d;
+                std::memcpy(&d, p + 8 * lane, 8);
+                uint64_t k = d ^ (SECRET[lane] + stripe_key);
+                acc[lane] += (k & 0xffffffffULL) * (k >> 32);
+                acc[lane] += d;
+            }
+        }
+
+        uint64_t h = len * PRIME1;
+        for (int lane = 0; lane < 4; lane++)
+            h = mix(h ^ mix(acc[lane] + lane));
+
+        // Tail bytes
+        for (uint64_t i = stripes * 32; i < len; i++)
+            h = mix(h ^ (data[i] * PRIME5 + i));
+
+        return h;
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    // Final avalanche (MurmurHash3 fmix64)
+    static uint64_t mix(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+};
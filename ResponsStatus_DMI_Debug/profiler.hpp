@@ -0,0 +1,261 @@
+#pragma once
+
+#include "systemc"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Wall-clock profiler for SystemC processes and socket callbacks
+ * The models are always instrumented; profiling is switched on at run time by setting the
+ * environment variable SC_PROFILE (to anything but "0"), so no recompilation is needed.
+ * When it is off every probe is a null pointer and the instrumentation costs one branch.
+ *
+ * Host time is charged exclusively: at any moment it goes to the innermost open scope of the
+ * running process, i.e. a callback invoked by an initiator thread is not counted in the
+ * thread's own time. Because the kernel switches processes inside wait(), instrumented code
+ * waits through Profiler::wait, which stops the clock of the current process and resumes it
+ * when the process is activated again.
+ */
+class Profiler
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    // One line of the report: a process or a socket callback
+    struct Probe
+    {
+        std::string name;
+        std::string kind;
+        unsigned long long calls = 0; // Activations for processes, calls for callbacks
+        double host_s = 0;            // Exclusive host time
+    };
+
+    // Per-process state, owned by the module that runs the process
+    struct Process
+    {
+        Probe *probe = nullptr;
+        std::vector<Probe *> stack; // Open scopes, the process itself at the bottom
+    };
+
+    static Profiler &instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    bool enabled() const
+    {
+        return enabled_;
+    }
+
+    // Create a probe, returns nullptr when profiling is disabled
+    Probe *probe(const std::string &name, const std::string &kind)
+    {
+        if (!enabled_)
+            return nullptr;
+        probes_.emplace_back(new Probe);
+        probes_.back()->name = name;
+        probes_.back()->kind = kind;
+        return probes_.back().get();
+    }
+
+    void init_process(Process &process, const std::string &name)
+    {
+        process.probe = probe(name, "process");
+    }
+
+    // Called when a process starts or resumes after a wait
+    void activate(Process &process)
+    {
+        if (!process.probe)
+            return;
+        last_ = clock::now();
+        running_ = &process;
+        if (process.stack.empty())
+            process.stack.push_back(process.probe);
+        process.probe->calls++;
+    }
+
+    // Called when a process returns, later host time is no longer charged to it
+    void finish(Process &process)
+    {
+        if (!process.probe)
+            return;
+        charge();
+        process.stack.clear();
+        if (running_ == &process)
+            running_ = nullptr;
+    }
+
+    // Open and close a callback scope on the running process
+    void enter(Probe *probe)
+    {
+        charge();
+        probe->calls++;
+        if (running_)
+            running_->stack.push_back(probe);
+    }
+
+    void leave()
+    {
+        charge();
+        if (running_ && running_->stack.size() > 1)
+            running_->stack.pop_back();
+    }
+
+    // wait() that stops the clock of the current process while other processes run
+    template <typename T>
+    void wait(const T &t)
+    {
+        if (!enabled_)
+        {
+            sc_core::wait(t);
+            return;
+        }
+
+        charge();
+        Process *self = running_;
+        running_ = nullptr;
+        sc_core::wait(t);
+        if (self)
+        {
+            self->probe->calls++;
+            running_ = self;
+        }
+        last_ = clock::now();
+    }
+
+    void start()
+    {
+        wall_start_ = clock::now();
+        last_ = wall_start_;
+    }
+
+    // Ranked report, most expensive first
+    void report(std::ostream &os)
+    {
+        if (!enabled_)
+            return;
+
+        charge();
+        double wall_s = std::chrono::duration<double>(clock::now() - wall_start_).count();
+        double sim_s = sc_core::sc_time_stamp().to_seconds();
+
+        std::vector<Probe *> ranked;
+        double attributed_s = 0;
+        for (auto &probe : probes_)
+        {
+            ranked.push_back(probe.get());
+            attributed_s += probe->host_s;
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const Probe *a, const Probe *b)
+                  { return a->host_s > b->host_s; });
+
+        os << "\n*** Profile: " << std::dec << wall_s * 1e3 << " ms wall for " << sc_core::sc_time_stamp()
+           << " simulated, sim/wall ratio " << (wall_s > 0 ? sim_s / wall_s : 0.0) << "\n";
+        os << std::left << std::setw(10) << "kind" << std::setw(48) << "name"
+           << std::right << std::setw(12) << "calls" << std::setw(14) << "host ms" << std::setw(10) << "% wall" << "\n";
+        for (const Probe *probe : ranked)
+        {
+            os << std::left << std::setw(10) << probe->kind << std::setw(48) << probe->name
+               << std::right << std::setw(12) << probe->calls
+               << std::setw(14) << std::fixed << std::setprecision(3) << probe->host_s * 1e3
+               << std::setw(10) << std::setprecision(1) << (wall_s > 0 ? 100 * probe->host_s / wall_s : 0.0) << "\n";
+        }
+        os << std::left << std::setw(10) << "kernel" << std::setw(48) << "(scheduler, unprofiled code)"
+           << std::right << std::setw(12) << "-"
+           << std::setw(14) << std::setprecision(3) << (wall_s - attributed_s) * 1e3
+           << std::setw(10) << std::setprecision(1) << (wall_s > 0 ? 100 * (wall_s - attributed_s) / wall_s : 0.0) << "\n";
+        os.unsetf(std::ios::floatfield);
+        os << std::setprecision(6);
+    }
+
+    // RAII scope for the body of a process: activates it on entry, finishes it on return
+    class ProcessScope
+    {
+    public:
+        explicit ProcessScope(Process &process) : process_(process)
+        {
+            Profiler::instance().activate(process_);
+        }
+
+        ~ProcessScope()
+        {
+            Profiler::instance().finish(process_);
+        }
+
+    private:
+        Process &process_;
+    };
+
+    // RAII scope for a socket callback
+    class Scope
+    {
+    public:
+        explicit Scope(Probe *probe) : probe_(probe)
+        {
+            if (probe_)
+                Profiler::instance().enter(probe_);
+        }
+
+        ~Scope()
+        {
+            if (probe_)
+                Profiler::instance().leave();
+        }
+
+    private:
+        Probe *probe_;
+    };
+
+private:
+    Profiler()
+    {
+        const char *env = std::getenv("SC_PROFILE");
+        enabled_ = env && *env && std::string(env) != "0";
+        start();
+    }
+
+    // Charge the time since the last event to the innermost scope of the running process
+    void charge()
+    {
+        clock::time_point now = clock::now();
+        if (running_ && !running_->stack.empty())
+            running_->stack.back()->host_s += std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+    }
+
+    bool enabled_ = false;
+    std::vector<std::unique_ptr<Probe>> probes_;
+    Process *running_ = nullptr;
+    clock::time_point last_;
+    clock::time_point wall_start_;
+};
+
+/**
+ * @brief Prints the profile when the simulation ends
+ * Instantiate once in the top level; start_of_simulation starts the wall clock.
+ */
+class ProfilerReport : sc_core::sc_module
+{
+public:
+    ProfilerReport(sc_core::sc_module_name name) {}
+
+private:
+    virtual void start_of_simulation()
+    {
+        Profiler::instance().start();
+    }
+
+    virtual void end_of_simulation()
+    {
+        Profiler::instance().report(std::cout);
+    }
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "profiler.hpp"
+
+/**
+ * @brief Binary log of b_transport transactions and their responses
+ * A header followed by fixed-size records, record n being the n-th b_transport call,
+ * so a replay finds any transaction at a constant offset without parsing the file.
+ * Times are in units of the time resolution.
+ */
+namespace response_log
+{
+    enum
+    {
+        MAX_DATA = 16,      // Bytes of data stored per record, longer transactions are not logged
+        MAGIC = 0x524D4C54, // "TLMR"
+        VERSION = 1
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t record_size;
+        uint32_t reserved;
+        uint64_t count; // Number of records
+    };
+
+    struct Record
+    {
+        uint64_t time;      // Simulation time of the call
+        uint64_t address;
+        uint64_t delay_in;  // Delay annotated by the initiator
+        uint64_t delay_out; // Delay annotated by the target on return
+        uint64_t waited;    // Simulation time the target spent waiting inside b_transport
+        uint32_t command;
+        uint32_t length;
+        int32_t response;   // tlm_response_status
+        uint32_t dmi_allowed;
+        unsigned char data[MAX_DATA]; // Write data, or data returned by a read
+    };
+}
+
+/**
+ * @brief Pass-through module capturing every b_transport call into a response log
+ * Insert it between an initiator and its target. DMI is refused, so that every access
+ * goes through b_transport and is captured; the DMI hint itself is recorded unchanged.
+ * Debug transport is forwarded without being recorded.
+ */
+class Recorder : sc_module
+{
+public:
+    tlm_utils::simple_target_socket<Recorder> target_socket;
+    tlm_utils::simple_initiator_socket<Recorder> initiator_socket;
+
+    unsigned long long recorded = 0;
+
+    Recorder(sc_core::sc_module_name name, const string &log_path)
+        : target_socket("target_socket"), initiator_socket("initiator_socket")
+    {
+        target_socket.register_b_transport(this, &Recorder::b_transport);
+        target_socket.register_get_direct_mem_ptr(this, &Recorder::get_direct_mem_ptr);
+        target_socket.register_transport_dbg(this, &Recorder::transport_dbg);
+        initiator_socket.register_invalidate_direct_mem_ptr(this, &Recorder::invalidate_direct_mem_ptr);
+
+        log.open(log_path, ios::binary | ios::trunc);
+        if (!log.is_open())
+        {
+            SC_REPORT_ERROR("Recorder", ("Could not open the response log '" + log_path + "'").c_str());
+            return;
+        }
+
+        // The record count is patched in when the log is closed
+        response_log::Header header = {response_log::MAGIC, response_log::VERSION, sizeof(response_log::Record), 0, 0};
+        log.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    ~Recorder()
+    {
+        close();
+    }
+
+    void close()
+    {
+        if (!log.is_open())
+            return;
+
+        log.seekp(offsetof(response_log::Header, count));
+        uint64_t count = recorded;
+        log.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        log.close();
+    }
+
+private:
+    ofstream log;
+
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        response_log::Record record = {};
+        record.time = sc_time_stamp().value();
+        record.address = trans.get_address();
+        record.delay_in = delay.value();
+        record.command = trans.get_command();
+        record.length = trans.get_data_length();
+
+        if (record.length > response_log::MAX_DATA)
+        {
+            SC_REPORT_WARNING("Recorder", "Transaction longer than a log record, the log is not replayable");
+            record.length = response_log::MAX_DATA;
+        }
+        if (trans.is_write())
+            memcpy(record.data, trans.get_data_ptr(), record.length);
+
+        sc_time start = sc_time_stamp();
+        initiator_socket->b_transport(trans, delay);
+
+        record.waited = (sc_time_stamp() - start).value();
+        record.delay_out = delay.value();
+        record.response = trans.get_response_status();
+        record.dmi_allowed = trans.is_dmi_allowed();
+        if (trans.is_read())
+            memcpy(record.data, trans.get_data_ptr(), record.length);
+
+        if (log.is_open())
+            log.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        recorded++;
+    }
+
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data)
+    {
+        return false;
+    }
+
+    virtual unsigned int transport_dbg(tlm::tlm_generic_payload &trans)
+    {
+        return initiator_socket->transport_dbg(trans);
+    }
+
+    virtual void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range)
+    {
+        target_socket->invalidate_direct_mem_ptr(start_range, end_range);
+    }
+};
+
+/**
+ * @brief Target serving the responses of a recorded run, in place of the downstream model
+ * The log is mapped read-only and transaction n is served from record n. Each request is
+ * checked against its record: a different command, address, length or write data means the
+ * initiator diverged from the recording and is reported as an error, a different time or
+ * delay as a warning. Responses reproduce the recorded data, status, DMI hint and timing.
+ * DMI is refused as during recording; debug transport has no model behind it and returns 0 bytes.
+ */
+class ReplayTarget : sc_module
+{
+public:
+    tlm_utils::simple_target_socket<ReplayTarget> socket;
+
+    unsigned long long replayed = 0;
+    unsigned long long timing_mismatches = 0;
+
+    ReplayTarget(sc_core::sc_module_name name, const string &log_path) : socket("socket")
+    {
+        socket.register_b_transport(this, &ReplayTarget::b_transport);
+        socket.register_get_direct_mem_ptr(this, &ReplayTarget::get_direct_mem_ptr);
+        socket.register_transport_dbg(this, &ReplayTarget::transport_dbg);
+
+        int fd = open(log_path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(response_log::Header))
+        {
+            if (fd >= 0)
+                close(fd);
+            SC_REPORT_ERROR("ReplayTarget", ("Could not open the response log '" + log_path + "'").c_str());
+            return;
+        }
+
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            SC_REPORT_ERROR("ReplayTarget", ("Could not map the response log '" + log_path + "'").c_str());
+            return;
+        }
+        mapping_size = st.st_size;
+        mapping_base = mapping;
+
+        const response_log::Header *header = static_cast<const response_log::Header *>(mapping);
+        if (header->magic != response_log::MAGIC || header->version != response_log::VERSION ||
+            header->record_size != sizeof(response_log::Record) ||
+            header->count > (mapping_size - sizeof(response_log::Header)) / sizeof(response_log::Record))
+        {
+            SC_REPORT_ERROR("ReplayTarget", ("Invalid or truncated response log '" + log_path + "'").c_str());
+            return;
+        }
+
+        records = reinterpret_cast<const response_log::Record *>(header + 1);
+        count = header->count;
+    }
+
+    ~ReplayTarget()
+    {
+        if (mapping_base)
+            munmap(mapping_base, mapping_size);
+    }
+
+    // Number of recorded transactions not replayed, non-zero when the initiator stopped early
+    unsigned long long remaining() const
+    {
+        return count - replayed;
+    }
+
+private:
+    void *mapping_base = nullptr;
+    size_t mapping_size = 0;
+    const response_log::Record *records = nullptr;
+    uint64_t count = 0;
+
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        char txt[200];
+        if (replayed >= count)
+        {
+            snprintf(txt, sizeof(txt), "Transaction %llu is beyond the end of the log (%llu records)",
+                     replayed, static_cast<unsigned long long>(count));
+            SC_REPORT_ERROR("ReplayTarget", txt);
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+
+        // O(1) lookup: the n-th call is served by the n-th record
+        const response_log::Record &record = records[replayed];
+        unsigned int len = trans.get_data_length();
+
+        if (record.command != uint32_t(trans.get_command()) || record.address != trans.get_address() || record.length != len ||
+            (trans.is_write() && memcmp(record.data, trans.get_data_ptr(), len) != 0))
+        {
+            snprintf(txt, sizeof(txt), "Divergence at transaction %llu: got { %c, 0x%llx, %u bytes }, recorded { %c, 0x%llx, %u bytes }",
+                     replayed, trans.is_write() ? 'W' : 'R', static_cast<unsigned long long>(trans.get_address()), len,
+                     record.command == tlm::TLM_WRITE_COMMAND ? 'W' : 'R', static_cast<unsigned long long>(record.address), record.length);
+            SC_REPORT_ERROR("ReplayTarget", txt);
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+
+        if (record.time != sc_time_stamp().value() || record.delay_in != delay.value())
+        {
+            snprintf(txt, sizeof(txt), "Timing divergence at transaction %llu", replayed);
+            SC_REPORT_WARNING("ReplayTarget", txt);
+            timing_mismatches++;
+        }
+
+        if (trans.is_read())
+            memcpy(trans.get_data_ptr(), record.data, len);
+
+        replayed++;
+
+        // Reproduce the timing of the recorded target: the time it waited, then its annotation
+        if (record.waited)
+            Profiler::instance().wait(sc_time::from_value(record.waited));
+        delay = sc_time::from_value(record.delay_out);
+
+        trans.set_dmi_allowed(record.dmi_allowed != 0);
+        trans.set_response_status(static_cast<tlm::tlm_response_status>(record.response));
+    }
+
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data)
+    {
+        return false;
+    }
+
+    virtual unsigned int transport_dbg(tlm::tlm_generic_payload &trans)
+    {
+        return 0;
+    }
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "profiler.hpp"
+
+// Target module representing a read-only memory backed by an image file
+
+class Rom : sc_module
+{
+public:
+    // TLM-2 socket, defaults to 32-bits wide, base protocol
+    tlm_utils::simple_target_socket<Rom> socket;
+
+    const sc_time LATENCY;
+
+    /**
+     * The image is mapped read-only with shared pages instead of being copied, so every
+     * simulation process on the host that maps the same file shares one physical copy
+     * and startup costs one mmap regardless of the image size.
+     */
+    Rom(sc_core::sc_module_name name, const string &image_path)
+        : socket("socket"), LATENCY(10, SC_NS)
+    {
+        // Register callbacks for incoming interface method calls
+        socket.register_b_transport(this, &Rom::b_transport);
+        socket.register_get_direct_mem_ptr(this, &Rom::get_direct_mem_ptr);
+        socket.register_transport_dbg(this, &Rom::transport_dbg);
+
+        int fd = open(image_path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            SC_REPORT_ERROR("Rom", ("Could not open ROM image '" + image_path + "'").c_str());
+            return;
+        }
+
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // The mapping stays valid without the descriptor
+        if (mapping == MAP_FAILED)
+        {
+            SC_REPORT_ERROR("Rom", ("Could not map ROM image '" + image_path + "'").c_str());
+            return;
+        }
+
+        image = static_cast<const unsigned char *>(mapping);
+        size = st.st_size;
+
+        // Profiling probes, null unless SC_PROFILE is set
+        string socket_name = string(this->name()) + ".socket.";
+        prof_b_transport = Profiler::instance().probe(socket_name + "b_transport", "callback");
+        prof_get_direct_mem_ptr = Profiler::instance().probe(socket_name + "get_direct_mem_ptr", "callback");
+        prof_transport_dbg = Profiler::instance().probe(socket_name + "transport_dbg", "callback");
+    }
+
+    ~Rom()
+    {
+        if (image)
+            munmap(const_cast<unsigned char *>(image), size);
+    }
+
+private:
+    const unsigned char *image = nullptr;
+    sc_dt::uint64 size = 0;
+
+    Profiler::Probe *prof_b_transport = nullptr;
+    Profiler::Probe *prof_get_direct_mem_ptr = nullptr;
+    Profiler::Probe *prof_transport_dbg = nullptr;
+
+    /**
+     * @brief TLM-2 blocking transport method
+     * Same checks as Memory; a write is refused with the command error response,
+     * which indicates that the target does not support the command for this address.
+     */
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        Profiler::Scope profile(prof_b_transport);
+
+        tlm::tlm_command cmd = trans.get_command();
+        sc_dt::uint64 adr = trans.get_address();
+        unsigned char *ptr = trans.get_data_ptr();
+        unsigned int len = trans.get_data_length();
+        unsigned char *byt = trans.get_byte_enable_ptr();
+        unsigned int wid = trans.get_streaming_width();
+
+        if (adr >= size || adr + len > size)
+        {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+        }
+        if (byt != 0)
+        {
+            trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+        if (len > 4 || wid < len)
+        {
+            trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+            return;
+        }
+        if (cmd == tlm::TLM_WRITE_COMMAND)
+        {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+
+        if (cmd == tlm::TLM_READ_COMMAND)
+            memcpy(ptr, image + adr, len);
+
+        // Illustrates that b_transport may block
+        Profiler::instance().wait(delay);
+
+        // Reset timing annotation after waiting
+        delay = SC_ZERO_TIME;
+
+        trans.set_dmi_allowed(true);
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    /**
+     * @brief TLM-2 forward DMI method
+     * Grants read-only access directly into the shared mapping, whatever the mode of the request.
+     */
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data)
+    {
+        Profiler::Scope profile(prof_get_direct_mem_ptr);
+
+        if (!image)
+            return false;
+
+        dmi_data.allow_read();
+        dmi_data.set_dmi_ptr(const_cast<unsigned char *>(image));
+        dmi_data.set_start_address(0);
+        dmi_data.set_end_address(size - 1);
+        dmi_data.set_read_latency(LATENCY);
+
+        return true;
+    }
+
+    // TLM-2 debug transport method, debug writes are ignored (0 bytes transferred)
+    virtual unsigned int transport_dbg(tlm::tlm_generic_payload &trans)
+    {
+        Profiler::Scope profile(prof_transport_dbg);
+
+        sc_dt::uint64 adr = trans.get_address();
+        unsigned int len = trans.get_data_length();
+
+        if (trans.get_command() != tlm::TLM_READ_COMMAND || adr >= size)
+            return 0;
+
+        // Calculate the number of bytes to be actually copied
+        unsigned int num_bytes = (len < size - adr) ? len : size - adr;
+        memcpy(trans.get_data_ptr(), image + adr, num_bytes);
+
+        return num_bytes;
+    }
+};
@@ -37,6 +37,19 @@
 #include "systemc"
 #include "initiator.hpp"
 #include "memory.hpp"
+#include "banked_memory.hpp"
+#include "rom.hpp"
+#include "memory_digest.hpp"
+#include "response_log.hpp"
+#include "profiler.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -47,27 +60,262 @@ using namespace std;
 #include "tlm_utils/simple_target_socket.h"
 
 
+// Platform options, given as "--name=value" on the command line
+struct TopConfig
+{
+    unsigned int initiators = 1; // Number of initiators
+    unsigned int banks = 0;      // 0 = single-port Memory, else BankedMemory with this many banks
+    string rom;                  // Image file of a read-only target used instead of Memory
+    string digest;               // Write the per-page digest of the final memory contents here
+    string golden;               // Compare the final memory contents against this digest
+    bool dram = false;           // Use the DRAM timing model in Memory
+    string record;               // Capture the initiator's transactions and responses into this log
+    string replay;               // Serve the initiator from this log instead of a memory model
+    DramTiming::Params dram_params;
+
+    bool parse(int argc, char *argv[])
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg.compare(0, 13, "--initiators=") == 0)
+            {
+                if (!toUnsigned(arg.substr(13), initiators))
+                {
+                    cerr << "Error: malformed number in '" << arg << "'" << endl;
+                    return false;
+                }
+            }
+            else if (arg.compare(0, 8, "--banks=") == 0)
+            {
+                if (!toUnsigned(arg.substr(8), banks))
+                {
+                    cerr << "Error: malformed number in '" << arg << "'" << endl;
+                    return false;
+                }
+            }
+            else if (arg.compare(0, 6, "--rom=") == 0)
+                rom = arg.substr(6);
+            else if (arg == "--dram")
+                dram = true;
+            else if (arg.compare(0, 7, "--dram=") == 0)
+            {
+                // --dram=tCAS,tRCD,tRP in ns
+                unsigned int tCAS, tRCD, tRP;
+                if (sscanf(arg.c_str() + 7, "%u,%u,%u", &tCAS, &tRCD, &tRP) != 3)
+                {
+                    cerr << "Error: expected --dram=tCAS,tRCD,tRP" << endl;
+                    return false;
+                }
+                dram = true;
+                dram_params.tCAS = sc_time(tCAS, SC_NS);
+                dram_params.tRCD = sc_time(tRCD, SC_NS);
+                dram_params.tRP = sc_time(tRP, SC_NS);
+            }
+            else if (arg.compare(0, 9, "--digest=") == 0)
+                digest = arg.substr(9);
+            else if (arg.compare(0, 9, "--golden=") == 0)
+                golden = arg.substr(9);
+            else if (arg.compare(0, 9, "--record=") == 0)
+                record = arg.substr(9);
+            else if (arg.compare(0, 9, "--replay=") == 0)
+                replay = arg.substr(9);
+            else
+            {
+                cerr << "Error: unknown option '" << arg << "'" << endl;
+                return false;
+            }
+        }
+
+        // The DRAM timing model is attached to the single-port Memory only
+        if (dram && (banks > 0 || initiators > 1 || !rom.empty()))
+        {
+            cerr << "Error: --dram needs the single-port Memory (no --banks, --rom or several initiators)" << endl;
+            return false;
+        }
+
+        // Several initiators need the multi-port BankedMemory
+        if (initiators > 1 && banks == 0)
+            banks = 4;
+        if (!rom.empty() && initiators > 1)
+        {
+            cerr << "Error: the ROM has a single port" << endl;
+            return false;
+        }
+        if ((!record.empty() || !replay.empty()) && initiators > 1)
+        {
+            cerr << "Error: record and replay support a single initiator" << endl;
+            return false;
+        }
+        if (!replay.empty() && (!record.empty() || !rom.empty() || dram || !digest.empty() || !golden.empty()))
+        {
+            cerr << "Error: a replay has no memory model to record, configure or digest" << endl;
+            return false;
+        }
+        if (initiators == 0)
+        {
+            cerr << "Error: --initiators must be > 0" << endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // The whole value must be an unsigned number (decimal, 0x hex or 0 octal)
+    static bool toUnsigned(const string &value, unsigned int &out)
+    {
+        if (value.empty() || !isdigit(static_cast<unsigned char>(value[0])))
+            return false;
+        char *end = nullptr;
+        errno = 0;
+        unsigned long n = strtoul(value.c_str(), &end, 0);
+        if (errno != 0 || *end != '\0' || n > numeric_limits<unsigned int>::max())
+            return false;
+        out = static_cast<unsigned int>(n);
+        return true;
+    }
+};
+
 SC_MODULE(Top)
 {
-    Initiator *initiator;
-    Memory *memory;
+    vector<Initiator *> initiators;
+    Memory *memory = nullptr;
+    BankedMemory *banked_memory = nullptr;
+    Rom *rom = nullptr;
+    DramTiming *dram = nullptr;
+    Recorder *recorder = nullptr;
+    ReplayTarget *replay = nullptr;
+    ProfilerReport *profiler;
 
-    SC_CTOR(Top)
+    SC_HAS_PROCESS(Top);
+    Top(sc_core::sc_module_name name, const TopConfig &config)
     {
+        // Prints a ranked wall-clock profile at the end of simulation when SC_PROFILE is set
+        profiler = new ProfilerReport("profiler");
+
         // Instantiate components
-        initiator = new Initiator("initiator");
-        memory = new Memory("memory");
+        for (unsigned int k = 0; k < config.initiators; k++)
+        {
+            string initiator_name = config.initiators > 1 ? "initiator_" + to_string(k) : "initiator";
+            initiators.push_back(new Initiator(initiator_name.c_str()));
+        }
+
+        // With --record the initiator reaches its target through a capturing pass-through
+        if (!config.record.empty())
+        {
+            recorder = new Recorder("recorder", config.record);
+            initiators[0]->socket.bind(recorder->target_socket);
+        }
 
-        // One initiator is bound directly to one target with no intervening bus
+        if (!config.replay.empty())
+        {
+            // Recorded responses stand in for the downstream model
+            replay = new ReplayTarget("replay", config.replay);
+            bind_first(replay->socket);
+        }
+        else if (!config.rom.empty())
+        {
+            // Read-only image shared with every other process mapping the same file
+            rom = new Rom("rom", config.rom);
+            initiators[0]->read_only = true;
+            bind_first(rom->socket);
+        }
+        else if (config.banks == 0)
+        {
+            memory = new Memory("memory");
+            if (config.dram)
+            {
+                dram = new DramTiming(config.dram_params);
+                memory->dram = dram;
+            }
 
-        // Bind initiator socket to target socket
-        initiator->socket.bind(memory->socket);
+            // One initiator is bound directly to one target with no intervening bus
+
+            // Bind initiator socket to target socket
+            bind_first(memory->socket);
+        }
+        else
+        {
+            // Every initiator gets its own port of the banked memory
+            banked_memory = new BankedMemory("memory", config.banks);
+            bind_first(banked_memory->socket);
+            for (unsigned int k = 1; k < initiators.size(); k++)
+                initiators[k]->socket.bind(banked_memory->socket);
+        }
+    }
+
+    // Bind the first initiator to its target, through the recorder when capturing
+    template <typename SOCKET>
+    void bind_first(SOCKET &target)
+    {
+        if (recorder)
+            recorder->initiator_socket.bind(target);
+        else
+            initiators[0]->socket.bind(target);
+    }
+
+    virtual void end_of_simulation()
+    {
+        if (banked_memory)
+            banked_memory->print_statistics();
+        if (dram)
+            dram->print_statistics("memory");
+        if (recorder)
+        {
+            recorder->close();
+            cout << "recorder: " << dec << recorder->recorded << " transactions recorded" << endl;
+        }
+        if (replay)
+            cout << "replay: " << dec << replay->replayed << " transactions replayed, " << replay->remaining()
+                 << " not reached, " << replay->timing_mismatches << " timing mismatches" << endl;
     }
 };
 
 int sc_main(int argc, char *argv[])
 {
-    Top top("top");
+    TopConfig config;
+    if (!config.parse(argc, argv))
+        return 1;
+
+    Top top("top", config);
+
+    // The downstream model draws rand() while it is constructed, and a replay has no such model.
+    // Reseeding after elaboration gives the initiator the same random stream in both runs.
+    if (!config.record.empty() || !config.replay.empty())
+        srand(1);
+
     sc_start();
+
+    // Ends the simulation so that end_of_simulation callbacks (the profile report) run
+    if (!sc_end_of_simulation_invoked())
+        sc_stop();
+
+    // Regression check on the final memory contents: one debug read, then per-page hashes
+    if (!config.digest.empty() || !config.golden.empty())
+    {
+        vector<unsigned char> contents(1 << 20);
+        unsigned int n_bytes = top.initiators[0]->debug_read(0, contents.data(), contents.size());
+        MemoryDigest digest = MemoryDigest::compute(contents.data(), n_bytes, 64);
+
+        if (!config.digest.empty() && !digest.save(config.digest))
+            return 1;
+
+        if (!config.golden.empty())
+        {
+            MemoryDigest golden;
+            if (!golden.load(config.golden))
+            {
+                cerr << "Error: invalid digest file '" << config.golden << "'" << endl;
+                return 1;
+            }
+
+            vector<MemoryDigest::Range> ranges = MemoryDigest::diff(golden, digest);
+            cout << "Memory digest vs " << config.golden << ": "
+                 << (ranges.empty() ? "match" : "MISMATCH") << endl;
+            MemoryDigest::print(cout, ranges);
+            if (!ranges.empty())
+                return 2;
+        }
+    }
     return 0;
 }
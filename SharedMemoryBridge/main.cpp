@@ -0,0 +1,164 @@
+// Two-process simulation of the Initiator_Receiver platform
+//
+// The initiators and the memory are simulated by separate processes, each with its own
+// SystemC kernel, connected by the shared-memory bridge of shm_bridge.h.
+//
+// Usage:
+//   SharedMemoryBridge --role=memory    [--shm=/tlm_bridge] [--latency=N] ...
+//   SharedMemoryBridge --role=generator [--shm=/tlm_bridge] [--bridge_quantum=ns] [--posted=0|1]
+//                      [--initiators=N] [--transactions=N] [--quantum=ns] ...
+//   SharedMemoryBridge --role=both ...   (forks the memory side, then runs the generators)
+//
+// Any other --name=value argument is a SimConfig parameter of Initiator_Receiver.
+
+#include "systemc"
+#include "tlm.h"
+
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "initiator.h"
+#include "memory.h"
+#include "shm_bridge.h"
+#include "sim_config.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+int run_memory(const SimConfig &config, const string &shm_name, bool create = true)
+{
+    Memory *memory = new Memory("memory");
+    memory->latency = sc_time(config.latency_ns, SC_NS);
+
+    BridgeInitiatorProxy *proxy = new BridgeInitiatorProxy("bridge", shm_name, create);
+    proxy->socket.bind(memory->socket);
+
+    // Runs until the generator side ends, the proxy then stops the simulation
+    sc_start();
+
+    // Modules are never destroyed, remove the shared object explicitly
+    proxy->close();
+
+    cout << "memory side: " << dec << proxy->served << " transactions served, " << proxy->late
+         << " late, ended at " << sc_time_stamp() << endl;
+    return proxy->aborted ? 1 : 0;
+}
+
+int run_generator(const SimConfig &config, const string &shm_name, unsigned int bridge_quantum_ns, bool posted)
+{
+    BridgeTargetProxy *proxy = new BridgeTargetProxy("bridge", shm_name);
+    proxy->quantum = sc_time(bridge_quantum_ns, SC_NS);
+    proxy->posted_writes = posted;
+    if (!proxy->connected())
+        return 1;
+
+    // All initiators share the remote memory through the multi-port proxy socket
+    vector<Initiator *> initiators;
+    for (unsigned int k = 0; k < config.initiators; k++)
+    {
+        string suffix = config.initiators > 1 ? "_" + to_string(k) : "";
+        Initiator *initiator = new Initiator(("initiator" + suffix).c_str());
+        initiator->transactions = config.transactions;
+        initiator->size = config.size;
+        initiator->quantum = sc_time(config.quantum_ns, SC_NS);
+        initiator->verbose = config.verbose;
+        initiator->socket.bind(proxy->socket);
+        initiators.push_back(initiator);
+    }
+
+    sc_start();
+    proxy->shutdown();
+
+    unsigned long long completed = 0;
+    for (Initiator *initiator : initiators)
+        completed += initiator->completed;
+    cout << "generator side: " << dec << completed << " transactions completed, " << proxy->forwarded
+         << " forwarded, ended at " << sc_time_stamp() << endl;
+    return 0;
+}
+
+int sc_main(int argc, char *argv[])
+{
+    string role = "both";
+    string shm_name = "/tlm_bridge";
+    unsigned int bridge_quantum_ns = 1000;
+    bool posted = false; // Posted writes skip the memory latency, opt in with --posted=1
+
+    // Take the bridge arguments out, the rest are SimConfig parameters
+    vector<char *> args = {argv[0]};
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 7, "--role=") == 0)
+            role = arg.substr(7);
+        else if (arg.compare(0, 6, "--shm=") == 0)
+            shm_name = arg.substr(6);
+        else if (arg.compare(0, 17, "--bridge_quantum=") == 0)
+        {
+            if (!SimConfig::toUnsigned(arg.substr(17), bridge_quantum_ns))
+            {
+                cerr << "Error: malformed number '" << arg.substr(17) << "' for parameter 'bridge_quantum'\n";
+                return 1;
+            }
+        }
+        else if (arg.compare(0, 9, "--posted=") == 0)
+        {
+            if (!SimConfig::toFlag(arg.substr(9), posted))
+            {
+                cerr << "Error: malformed number '" << arg.substr(9) << "' for parameter 'posted'\n";
+                return 1;
+            }
+        }
+        else
+            args.push_back(argv[i]);
+    }
+
+    SimConfig config;
+    if (!config.parse(static_cast<int>(args.size()), args.data()))
+        return 1;
+    if (config.batch > 1 || config.cache_bytes > 0 || config.initiator != "thread")
+    {
+        cerr << "Error: the bridge forwards plain transactions of the thread initiator only\n";
+        return 1;
+    }
+
+    srand(config.seed);
+
+    if (role == "memory")
+        return run_memory(config, shm_name);
+    if (role == "generator")
+        return run_generator(config, shm_name, bridge_quantum_ns, posted);
+    if (role != "both")
+    {
+        cerr << "Error: role must be 'memory', 'generator' or 'both'\n";
+        return 1;
+    }
+
+    // Create the shared object before forking, so that the generator cannot attach to one
+    // left behind by an earlier run while the child is still elaborating
+    shm_bridge::Shared *shared = shm_bridge::create_shared(shm_name);
+    if (!shared)
+        return 1;
+    munmap(shared, sizeof(shm_bridge::Shared));
+
+    // Nothing is elaborated yet, so the child gets a pristine kernel of its own
+    pid_t child = fork();
+    if (child < 0)
+    {
+        cerr << "Error: fork failed\n";
+        shm_unlink(shm_name.c_str());
+        return 1;
+    }
+    if (child == 0)
+        return run_memory(config, shm_name, false);
+
+    int result = run_generator(config, shm_name, bridge_quantum_ns, posted);
+    int status = 0;
+    if (waitpid(child, &status, 0) != child)
+        return 1; // Already reaped by the bridge, which found it had exited early
+    return result != 0 ? result : (WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+}
@@ -0,0 +1,570 @@
+#pragma once
+
+#include "systemc"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/multi_passthrough_target_socket.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+/// TLM-2 bridge between two simulation processes on the same host.
+///
+/// A platform is split in two partitions, each simulated by its own process (and core):
+///   generator side: initiators bound to a BridgeTargetProxy
+///   memory side:    a BridgeInitiatorProxy bound to the memory subsystem
+/// b_transport and transport_dbg calls are forwarded through two lock-free single-producer/
+/// single-consumer rings (requests and responses) in a POSIX shared-memory object.
+///
+/// Time synchronization is quantum based: every request carries the generator's local time,
+/// the memory side advances its own kernel to that time before serving it, and the generator
+/// never runs more than one quantum ahead of the published memory-side time. Reads and debug
+/// accesses are round trips, and so are writes unless posted writes are enabled: these let both
+/// partitions run in parallel, their responses being checked asynchronously, at the cost of
+/// their latency not being annotated.
+
+namespace shm_bridge
+{
+    enum
+    {
+        MAX_DATA = 64,     // Largest data length forwarded by one message
+        RING_SLOTS = 1024, // Messages per ring, a power of two
+        MAGIC = 0x54424D53, // "SMBT", set once the shared object is initialized
+        ATTACH_TIMEOUT_MS = 10000 // How long either side waits for its peer to attach
+    };
+
+    enum MessageKind : uint32_t
+    {
+        B_TRANSPORT,
+        TRANSPORT_DBG,
+        END // The generator side has finished
+    };
+
+    struct Message
+    {
+        uint32_t kind;
+        uint32_t command;
+        uint64_t sequence;
+        uint64_t address;
+        uint32_t length;     // Request: data length, debug response: bytes transferred
+        int32_t response;    // tlm_response_status
+        uint64_t time;       // Request: generator time of the access, in time resolution units
+        uint64_t delay;      // Response: latency annotated by the memory side
+        uint32_t posted;     // Write completed early on the generator side
+        unsigned char data[MAX_DATA];
+    };
+
+    // Lock-free single-producer/single-consumer ring
+    struct Ring
+    {
+        alignas(64) std::atomic<uint64_t> head; // Written by the producer
+        alignas(64) std::atomic<uint64_t> tail; // Written by the consumer
+        Message slots[RING_SLOTS];
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+        bool try_push(const Message &msg)
+        {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) == RING_SLOTS)
+                return false;
+            slots[h % RING_SLOTS] = msg;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop(Message &msg)
+        {
+            uint64_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire))
+                return false;
+            msg = slots[t % RING_SLOTS];
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+    };
+
+    struct Shared
+    {
+        std::atomic<uint32_t> magic;
+        std::atomic<int32_t> memory_pid;      // Serving memory-side process, 0 until its proxy is ready
+        std::atomic<int32_t> generator_pid;   // Attached generator-side process, 0 until one attaches
+        std::atomic<uint64_t> generator_time; // Published by the generator side
+        std::atomic<uint64_t> memory_time;    // Published by the memory side
+        Ring requests;                        // Generator -> memory
+        Ring responses;                       // Memory -> generator
+    };
+
+    // Is the process still running? An exited child of ours (--role=both) is reaped here,
+    // since as a zombie it would still pass kill(pid, 0)
+    inline bool alive(int32_t pid)
+    {
+        if (pid <= 0)
+            return false;
+        int status;
+        if (waitpid(pid, &status, WNOHANG) == pid)
+            return false;
+        return kill(pid, 0) == 0 || errno == EPERM;
+    }
+
+    // Host-side wait for the peer process, which never advances simulation time
+    class PeerWait
+    {
+    public:
+        explicit PeerWait(const std::atomic<int32_t> *peer_pid)
+            : peer_pid(peer_pid), start(std::chrono::steady_clock::now())
+        {
+        }
+
+        // Yield the core; false once the peer has exited, or has not attached within ATTACH_TIMEOUT_MS
+        bool yield()
+        {
+            sched_yield();
+            if (++spins % 4096 != 0)
+                return true;
+
+            int32_t pid = peer_pid->load(std::memory_order_acquire);
+            if (pid == 0)
+                return std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ATTACH_TIMEOUT_MS);
+            return alive(pid);
+        }
+
+    private:
+        const std::atomic<int32_t> *peer_pid;
+        std::chrono::steady_clock::time_point start;
+        unsigned long long spins = 0;
+    };
+
+    // Create a fresh shared object, replacing any object left behind by an earlier run
+    inline Shared *create_shared(const string &name)
+    {
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ftruncate(fd, sizeof(Shared)) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+        if (fd < 0)
+        {
+            SC_REPORT_ERROR("shm_bridge", ("Could not create shared memory '" + name + "'").c_str());
+            return nullptr;
+        }
+
+        void *mapping = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            SC_REPORT_ERROR("shm_bridge", ("Could not map shared memory '" + name + "'").c_str());
+            return nullptr;
+        }
+
+        // A fresh object is zero-filled, which is a valid initial state for the atomics
+        Shared *shared = static_cast<Shared *>(mapping);
+        shared->memory_pid.store(0);
+        shared->generator_pid.store(0);
+        shared->generator_time.store(0);
+        shared->memory_time.store(0);
+        shared->requests.head.store(0);
+        shared->requests.tail.store(0);
+        shared->responses.head.store(0);
+        shared->responses.tail.store(0);
+        shared->magic.store(MAGIC, std::memory_order_release);
+        return shared;
+    }
+
+    // Map an existing shared object, nullptr if there is none (yet)
+    inline Shared *open_shared(const string &name)
+    {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat st;
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Shared))
+            mapping = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return mapping == MAP_FAILED ? nullptr : static_cast<Shared *>(mapping);
+    }
+
+    /**
+     * Generator side: wait up to ATTACH_TIMEOUT_MS for a memory side to serve the object.
+     * An object left behind by an earlier run still holds MAGIC, so it is only accepted once
+     * its memory-side process is running and no other generator has attached to it;
+     * otherwise it is mapped again, as the memory side replaces stale objects when it starts.
+     */
+    inline Shared *attach_shared(const string &name)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ATTACH_TIMEOUT_MS);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            Shared *shared = open_shared(name);
+            if (shared)
+            {
+                int32_t none = 0;
+                if (shared->magic.load(std::memory_order_acquire) == MAGIC &&
+                    alive(shared->memory_pid.load(std::memory_order_acquire)) &&
+                    shared->generator_pid.compare_exchange_strong(none, getpid()))
+                    return shared;
+                munmap(shared, sizeof(Shared));
+            }
+            usleep(10000);
+        }
+
+        SC_REPORT_ERROR("shm_bridge", ("No memory side serving shared memory '" + name + "'").c_str());
+        return nullptr;
+    }
+}
+
+/// Generator-side proxy: looks like a target to any number of local initiators
+/// and forwards their transactions to the memory-side process.
+
+class BridgeTargetProxy : sc_module
+{
+public:
+    tlm_utils::multi_passthrough_target_socket<BridgeTargetProxy> socket;
+
+    // Generator time may run at most this far ahead of the memory side
+    sc_time quantum = sc_time(1, SC_US);
+
+    // Complete writes immediately and check their responses asynchronously. The memory-side
+    // latency of a posted write is not known when it completes, so it is not annotated:
+    // faster, but simulated time differs from the same platform run in one process
+    bool posted_writes = false;
+
+    unsigned long long forwarded = 0;
+
+    BridgeTargetProxy(sc_core::sc_module_name name, const string &shm_name) : socket("socket")
+    {
+        socket.register_b_transport(this, &BridgeTargetProxy::b_transport);
+        socket.register_transport_dbg(this, &BridgeTargetProxy::transport_dbg);
+
+        shared = shm_bridge::attach_shared(shm_name);
+        if (shared)
+            peer = new shm_bridge::PeerWait(&shared->memory_pid);
+    }
+
+    // False when no memory side could be attached
+    bool connected() const
+    {
+        return shared != nullptr;
+    }
+
+    // Tell the memory side that no more transactions will come, and collect outstanding responses
+    void shutdown()
+    {
+        if (!shared)
+            return;
+
+        shm_bridge::Message msg = {};
+        msg.kind = shm_bridge::END;
+        msg.sequence = next_sequence++;
+        msg.time = sc_time_stamp().value();
+        if (send(msg))
+            await(msg.sequence, msg);
+
+        munmap(shared, sizeof(shm_bridge::Shared));
+        shared = nullptr;
+    }
+
+private:
+    shm_bridge::Shared *shared = nullptr;
+    shm_bridge::PeerWait *peer = nullptr;
+    uint64_t next_sequence = 0;
+
+    virtual void b_transport(int port, tlm::tlm_generic_payload &trans, sc_time &delay)
+    {
+        unsigned int len = trans.get_data_length();
+        if (!shared)
+        {
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+        if (trans.get_byte_enable_ptr() != 0)
+        {
+            trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+        if (len > shm_bridge::MAX_DATA || trans.get_streaming_width() < len)
+        {
+            trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+            return;
+        }
+
+        sc_time now = sc_time_stamp() + delay;
+
+        shm_bridge::Message msg = {};
+        msg.kind = shm_bridge::B_TRANSPORT;
+        msg.command = trans.get_command();
+        msg.sequence = next_sequence++;
+        msg.address = trans.get_address();
+        msg.length = len;
+        msg.time = now.value();
+        msg.posted = posted_writes && trans.is_write();
+        if (trans.is_write())
+            memcpy(msg.data, trans.get_data_ptr(), len);
+
+        if (!synchronize(now) || !send(msg))
+        {
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+        forwarded++;
+
+        // A posted write completes now; the memory side checks it in order with later accesses
+        if (msg.posted)
+        {
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            return;
+        }
+
+        if (!await(msg.sequence, msg))
+        {
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+        if (trans.is_read())
+            memcpy(trans.get_data_ptr(), msg.data, len);
+        delay += sc_time::from_value(msg.delay);
+        trans.set_response_status(static_cast<tlm::tlm_response_status>(msg.response));
+    }
+
+    virtual unsigned int transport_dbg(int port, tlm::tlm_generic_payload &trans)
+    {
+        if (!shared)
+            return 0;
+
+        shm_bridge::Message msg = {};
+        msg.kind = shm_bridge::TRANSPORT_DBG;
+        msg.command = trans.get_command();
+        msg.sequence = next_sequence++;
+        msg.address = trans.get_address();
+        msg.length = std::min<unsigned int>(trans.get_data_length(), shm_bridge::MAX_DATA);
+        msg.time = sc_time_stamp().value();
+        if (trans.is_write())
+            memcpy(msg.data, trans.get_data_ptr(), msg.length);
+
+        if (!send(msg) || !await(msg.sequence, msg))
+            return 0;
+
+        if (trans.is_read())
+            memcpy(trans.get_data_ptr(), msg.data, msg.length);
+        return msg.length;
+    }
+
+    // Host-side wait for the memory side, reports an error once it has exited
+    bool wait_peer()
+    {
+        if (peer->yield())
+            return true;
+        SC_REPORT_ERROR("shm_bridge", "The memory side has exited");
+        return false;
+    }
+
+    // Publish our time and hold back (in host time) while the memory side lags more than a quantum
+    bool synchronize(const sc_time &now)
+    {
+        shared->generator_time.store(now.value(), std::memory_order_release);
+        while (now.value() > shared->memory_time.load(std::memory_order_acquire) + quantum.value())
+        {
+            // Responses of posted writes must keep flowing, or the memory side could stall on a full ring
+            drain();
+            if (!wait_peer())
+                return false;
+        }
+        return true;
+    }
+
+    // Queue a request; while the ring is full keep draining responses, or both sides could block on full rings
+    bool send(const shm_bridge::Message &msg)
+    {
+        while (!shared->requests.try_push(msg))
+        {
+            drain();
+            if (!wait_peer())
+                return false;
+        }
+        return true;
+    }
+
+    // Wait for the response with the given sequence number, checking posted-write responses on the way
+    bool await(uint64_t sequence, shm_bridge::Message &msg)
+    {
+        while (true)
+        {
+            if (!shared->responses.try_pop(msg))
+            {
+                if (!wait_peer())
+                    return false;
+                continue;
+            }
+            if (msg.sequence == sequence)
+                return true;
+            check_posted(msg);
+        }
+    }
+
+    void drain()
+    {
+        shm_bridge::Message msg;
+        while (shared->responses.try_pop(msg))
+            check_posted(msg);
+    }
+
+    void check_posted(const shm_bridge::Message &msg)
+    {
+        if (msg.response != tlm::TLM_OK_RESPONSE)
+        {
+            char txt[100];
+            snprintf(txt, sizeof(txt), "Posted write to 0x%llx failed with response status %d",
+                     static_cast<unsigned long long>(msg.address), msg.response);
+            SC_REPORT_ERROR("shm_bridge", txt);
+        }
+    }
+};
+
+/// Memory-side proxy: receives the forwarded transactions and issues them to the local
+/// memory subsystem at the generator's time. Stops the simulation when the generator ends,
+/// exits, or does not attach within ATTACH_TIMEOUT_MS.
+
+class BridgeInitiatorProxy : sc_module
+{
+public:
+    tlm_utils::simple_initiator_socket<BridgeInitiatorProxy> socket;
+
+    unsigned long long served = 0;
+    unsigned long long late = 0; // Requests stamped earlier than the local time (decoupling skew)
+    bool aborted = false;        // The generator side was lost before it ended the run
+
+    /**
+     * The shared object is created here, replacing any object left behind by an earlier run,
+     * unless 'create' is false because the caller created it before forking the generator side.
+     */
+    SC_HAS_PROCESS(BridgeInitiatorProxy);
+    BridgeInitiatorProxy(sc_core::sc_module_name name, const string &shm_name, bool create = true)
+        : socket("socket"), shm_name(shm_name)
+    {
+        shared = create ? shm_bridge::create_shared(shm_name) : shm_bridge::open_shared(shm_name);
+        if (!shared)
+        {
+            if (!create)
+                SC_REPORT_ERROR("shm_bridge", ("Could not open shared memory '" + shm_name + "'").c_str());
+            return;
+        }
+
+        peer = new shm_bridge::PeerWait(&shared->generator_pid);
+        shared->memory_pid.store(getpid(), std::memory_order_release);
+
+        SC_THREAD(thread_process);
+    }
+
+    // Unmap and remove the shared object. SystemC does not destroy modules, so call it after sc_start
+    void close()
+    {
+        if (shared)
+        {
+            munmap(shared, sizeof(shm_bridge::Shared));
+            shm_unlink(shm_name.c_str());
+            shared = nullptr;
+        }
+    }
+
+private:
+    string shm_name;
+    shm_bridge::Shared *shared = nullptr;
+    shm_bridge::PeerWait *peer = nullptr;
+
+    void thread_process()
+    {
+        tlm::tlm_generic_payload trans;
+        shm_bridge::Message msg;
+
+        while (true)
+        {
+            shared->memory_time.store(sc_time_stamp().value(), std::memory_order_release);
+
+            if (!shared->requests.try_pop(msg))
+            {
+                // Idle: catch up with the generator's published time, else wait for work in host time
+                uint64_t peer_time = shared->generator_time.load(std::memory_order_acquire);
+                if (peer_time > sc_time_stamp().value())
+                    wait(sc_time::from_value(peer_time - sc_time_stamp().value()));
+                else if (!peer->yield())
+                    break;
+                continue;
+            }
+
+            if (msg.kind == shm_bridge::END)
+            {
+                respond(msg);
+                sc_stop();
+                return;
+            }
+
+            // Advance to the time of the access
+            if (msg.time > sc_time_stamp().value())
+                wait(sc_time::from_value(msg.time - sc_time_stamp().value()));
+            else if (msg.time < sc_time_stamp().value())
+                late++;
+
+            trans.set_command(static_cast<tlm::tlm_command>(msg.command));
+            trans.set_address(msg.address);
+            trans.set_data_ptr(msg.data);
+            trans.set_data_length(msg.length);
+            trans.set_streaming_width(msg.length);                   // = data_length to indicate no streaming
+            trans.set_byte_enable_ptr(0);                            // 0 indicates unused
+            trans.set_dmi_allowed(false);                            // Mandatory initial value
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE); // Mandatory initial value
+
+            if (msg.kind == shm_bridge::TRANSPORT_DBG)
+            {
+                msg.length = socket->transport_dbg(trans);
+                msg.response = tlm::TLM_OK_RESPONSE;
+            }
+            else
+            {
+                // The latency of the access is whatever the target annotates plus any time it waited
+                sc_time start = sc_time_stamp();
+                sc_time delay = SC_ZERO_TIME;
+                socket->b_transport(trans, delay);
+                msg.delay = (sc_time_stamp() - start + delay).value();
+                msg.response = trans.get_response_status();
+            }
+
+            if (!respond(msg))
+                break;
+            served++;
+        }
+
+        // The generator never attached, or exited without ending the run
+        aborted = true;
+        SC_REPORT_WARNING("shm_bridge", "The generator side is gone, stopping");
+        sc_stop();
+    }
+
+    bool respond(const shm_bridge::Message &msg)
+    {
+        while (!shared->responses.try_push(msg))
+        {
+            if (!peer->yield())
+                return false;
+        }
+        return true;
+    }
+};